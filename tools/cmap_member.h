@@ -0,0 +1,217 @@
+/*
+ * cmap_member.h - corosync membership lookup shared by pm_helper and fencecheckd
+ *
+ * Copyright (C) 2026 NIPPON TELEGRAPH AND TELEPHONE CORPORATION
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef CMAP_MEMBER_H
+#define CMAP_MEMBER_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <glib.h>
+#include <corosync/cmap.h>
+
+/**
+ * nodelist key to search a node
+ */
+#define CMAP_MEMBER_NODELIST_KEY "nodelist.node."
+
+/**
+ * format to get a node index and a last element from nodelist key
+ */
+#define CMAP_MEMBER_NODELIST_SCAN_FORMAT CMAP_MEMBER_NODELIST_KEY "%u.%s"
+
+/**
+ * format to make nodeid key from a node index
+ */
+#define CMAP_MEMBER_NODEID_FORMAT CMAP_MEMBER_NODELIST_KEY "%u.nodeid"
+
+/**
+ * member keys, searched in this order
+ * (the former is corosync-3.x, the latter is corosync-2.x)
+ */
+#define CMAP_MEMBER_KEY_V3 "runtime.members."
+#define CMAP_MEMBER_KEY_V2 "runtime.totem.pg.mrp.srp.members."
+
+/**
+ * the number of member key versions
+ */
+#define CMAP_MEMBER_KEY_VERSIONS 2
+
+/**
+ * format to make member status key from a member key and nodeid
+ */
+#define CMAP_MEMBER_STATUS_FORMAT "%s%u.status"
+
+/**
+ * member status value when a node is in the membership
+ */
+#define CMAP_MEMBER_STATUS_JOINED "joined"
+
+/**
+ * membership of a node
+ */
+enum cmap_member_state {
+    CMAP_MEMBER_UNKNOWN = 0,
+    CMAP_MEMBER_JOINED = 1,
+    CMAP_MEMBER_LEFT = 2
+};
+
+/**
+ * function deciding whether to retry a call which failed
+ * @param rc the result of the corosync call
+ * @return TRUE to retry the call
+ */
+typedef gboolean (*cmap_member_retry_fn)(cs_error_t rc);
+
+/**
+ * Search the nodelist for a node by its name or ring0 address
+ * @param handle cmap handler
+ * @param host the node name (compared without case)
+ * @param nodeid the nodeid of the node
+ * @param retry the retry function of the search, or NULL not to retry
+ * @return if found, CS_OK. if not found, CS_ERR_NOT_EXIST.
+ * otherwise, the error of cmap
+ */
+static inline cs_error_t
+cmap_member_find_nodeid(cmap_handle_t handle,
+        const char *host,
+        uint32_t *nodeid,
+        cmap_member_retry_fn retry)
+{
+    cs_error_t rc;
+    cmap_iter_handle_t iter_handle;
+    char key_name[CMAP_KEYNAME_MAXLEN + 1];
+    char tmp_key[CMAP_KEYNAME_MAXLEN + 1];
+    size_t value_len;
+    cmap_value_types_t type;
+    unsigned int node_idx;
+    char *value;
+    cs_error_t result = CS_ERR_NOT_EXIST;
+
+    while ((rc = cmap_iter_init(handle, CMAP_MEMBER_NODELIST_KEY, &iter_handle))
+            != CS_OK && retry != NULL && retry(rc)) {
+        ;
+    }
+    if (rc != CS_OK) {
+        return rc;
+    }
+
+    while (result == CS_ERR_NOT_EXIST
+            && cmap_iter_next(handle, iter_handle, key_name, &value_len, &type) == CS_OK) {
+        if (sscanf(key_name, CMAP_MEMBER_NODELIST_SCAN_FORMAT, &node_idx, tmp_key) != 2) {
+            continue;
+        }
+        if (strcmp(tmp_key, "name") != 0 && strcmp(tmp_key, "ring0_addr") != 0) {
+            continue;
+        }
+        if (cmap_get_string(handle, key_name, &value) != CS_OK) {
+            continue;
+        }
+        if (g_ascii_strcasecmp(value, host) == 0) {
+            snprintf(tmp_key, sizeof(tmp_key), CMAP_MEMBER_NODEID_FORMAT, node_idx);
+            if (cmap_get_uint32(handle, tmp_key, nodeid) == CS_OK) {
+                result = CS_OK;
+            }
+        }
+        free(value);
+    }
+
+    (void) cmap_iter_finalize(handle, iter_handle);
+    return result;
+}
+
+/**
+ * Check whether a cmap key prefix has any key
+ * @param handle cmap handler
+ * @param prefix key prefix
+ * @return if the prefix has a key, 1. otherwise 0.
+ */
+static inline int
+cmap_member_prefix_exists(cmap_handle_t handle,
+        const char *prefix)
+{
+    cmap_iter_handle_t iter_handle;
+    char key_name[CMAP_KEYNAME_MAXLEN + 1];
+    size_t value_len;
+    cmap_value_types_t type;
+    int exists = 0;
+
+    if (cmap_iter_init(handle, prefix, &iter_handle) != CS_OK) {
+        return 0;
+    }
+    if (cmap_iter_next(handle, iter_handle, key_name, &value_len, &type) == CS_OK) {
+        exists = 1;
+    }
+    (void) cmap_iter_finalize(handle, iter_handle);
+    return exists;
+}
+
+/**
+ * Get the membership of a node.
+ * A node which never joined has no status key in the version which
+ * has the member keys, so it is regarded as left.
+ * @param handle cmap handler
+ * @param nodeid the nodeid of the node
+ * @param retry the retry function of the status key, or NULL not to retry
+ * @param state the membership, CMAP_MEMBER_UNKNOWN unless CS_OK
+ * @return if the membership is decided, CS_OK. if no version has the
+ * member keys, CS_ERR_NOT_EXIST. otherwise, the error of cmap
+ */
+static inline cs_error_t
+cmap_member_get_state(cmap_handle_t handle,
+        uint32_t nodeid,
+        cmap_member_retry_fn retry,
+        enum cmap_member_state *state)
+{
+    const char *prefixes[CMAP_MEMBER_KEY_VERSIONS] = {
+            CMAP_MEMBER_KEY_V3, CMAP_MEMBER_KEY_V2
+    };
+    char tmp_key[CMAP_KEYNAME_MAXLEN + 1];
+    char *status;
+    cs_error_t rc;
+    int i;
+
+    *state = CMAP_MEMBER_UNKNOWN;
+    for (i = 0; i < CMAP_MEMBER_KEY_VERSIONS; i++) {
+        snprintf(tmp_key, sizeof(tmp_key), CMAP_MEMBER_STATUS_FORMAT, prefixes[i], nodeid);
+        while ((rc = cmap_get_string(handle, tmp_key, &status)) != CS_OK
+                && retry != NULL && retry(rc)) {
+            ;
+        }
+        if (rc == CS_OK) {
+            *state = strcmp(status, CMAP_MEMBER_STATUS_JOINED) == 0
+                    ? CMAP_MEMBER_JOINED : CMAP_MEMBER_LEFT;
+            free(status);
+            return CS_OK;
+        }
+        if (rc != CS_ERR_NOT_EXIST) {
+            return rc;
+        }
+        if (cmap_member_prefix_exists(handle, prefixes[i])) {
+            *state = CMAP_MEMBER_LEFT;
+            return CS_OK;
+        }
+    }
+    return CS_ERR_NOT_EXIST;
+}
+
+#endif /* CMAP_MEMBER_H */
@@ -0,0 +1,1086 @@
+/*
+ * fencecheckd - Daemon for keeping the state which stonith-helper checks
+ *
+ * Copyright (C) 2026 NIPPON TELEGRAPH AND TELEPHONE CORPORATION
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <arpa/inet.h>
+
+#include <corosync/cmap.h>
+#include <corosync/quorum.h>
+
+#include <crm/crm.h>
+#include <crm/common/mainloop.h>
+#include <crm_internal.h>
+
+#include "fencecheckd.h"
+#include "icmp_probe.h"
+#include "cmap_member.h"
+#include "pidfile.h"
+
+/**
+ * default system name
+ * (normally, execute file name)
+ */
+#define DEFAULT_SYS_NAME "fencecheckd"
+
+/**
+ * default pid file path
+ */
+#define PID_FILE "/var/run/fencecheckd.pid"
+
+/**
+ * interval to retry the connection to corosync(seconds)
+ */
+#define DEFAULT_INTERVAL 1
+
+/**
+ * interval of echo requests to a target(milliseconds)
+ */
+#define PROBE_INTERVAL_MSEC 1000
+
+/**
+ * time without a reply after which a target is logged as not responding
+ * (milliseconds)
+ */
+#define TARGET_LOST_MSEC 5000
+
+/**
+ * time without a query after which a target added by a query is no
+ * longer probed(milliseconds)
+ */
+#define TARGET_EXPIRE_MSEC 600000
+
+/**
+ * max number of probed targets
+ */
+#define MAX_TARGETS 64
+
+/**
+ * separator of the interface in a target
+ */
+#define TARGET_IF_SEPARATOR '%'
+
+/**
+ * separators of targets in an option and in a request
+ */
+#define TARGET_SEPARATORS ", \t"
+
+/**
+ * backlog of the query socket
+ */
+#define SERVER_BACKLOG 16
+
+/**
+ * kind of configure
+ */
+enum {
+    FC_CH_FG = 0,
+    FC_CH_MAX
+};
+
+/**
+ * probed target structure
+ */
+struct fence_target {
+    char *spec; /**< address[%interface] as configured or requested */
+    char *name; /**< address without the interface */
+    char *ifname; /**< interface to send from, or NULL */
+    struct sockaddr_storage addr; /**< resolved address */
+    socklen_t addrlen; /**< length of addr */
+    int raw; /**< 1 if fd is a raw socket, 0 if a ping socket */
+    int fd; /**< ICMP socket, -1 if not opened */
+    mainloop_io_t *source; /**< socket fd source */
+    uint16_t seq; /**< sequence number of the last echo request */
+    gint64 probing_since; /**< when the socket was opened(monotonic) */
+    gint64 last_reply; /**< the last echo reply(monotonic), 0 if none */
+    gboolean reachable; /**< TRUE while the target replies */
+    gboolean failed; /**< TRUE after the socket could not be opened */
+    gboolean configured; /**< TRUE if given by the options, never expires */
+    gint64 last_query; /**< the last query of the target(monotonic) */
+};
+
+/**
+ * query client structure
+ */
+struct fence_client {
+    int fd; /**< connected socket */
+    mainloop_io_t *source; /**< socket fd source */
+    size_t len; /**< received length of the request */
+    char buf[FENCECHECKD_REQUEST_LEN]; /**< request */
+};
+
+/**
+ * mainloop
+ */
+GMainLoop *mainloop = NULL;
+
+/**
+ * pid file name
+ */
+static char *pid_file;
+
+/**
+ * set each option, if true or false.
+ */
+static gboolean conf[FC_CH_MAX];
+
+/**
+ * targets given by the options, separated by ","
+ */
+static char *opt_targets;
+
+/**
+ * quorum state
+ */
+static struct {
+    quorum_handle_t handle; /**< quorum handler */
+    mainloop_io_t *source; /**< quorum fd source */
+    gboolean connected; /**< TRUE while tracking */
+    gboolean known; /**< TRUE after the first notification */
+    uint32_t quorate; /**< the last notified quorum state */
+    gint64 changed; /**< the last change(monotonic) */
+    guint timer_id; /**< connection retry timer id */
+} q_state;
+
+/**
+ * cmap handler to look up the membership, 0 if not connected
+ */
+static cmap_handle_t cmap_handle;
+
+/**
+ * probed targets
+ * (a slot whose spec is NULL is free)
+ */
+static struct fence_target targets[MAX_TARGETS];
+static int ntargets;
+
+/**
+ * identifier of echo requests
+ */
+static uint16_t probe_ident;
+
+/**
+ * probe timer id and the last probe(monotonic)
+ */
+static guint probe_timer_id;
+static gint64 probe_last_tick;
+
+/**
+ * query socket and its fd source
+ */
+static int server_fd = -1;
+static mainloop_io_t *server_source;
+
+/**
+ * options index
+ */
+static struct crm_option long_options[] = {
+        {"help", 0, 0, '?', "\tThis text"},
+        {"version", 0, 0, '$', "\tVersion information"},
+        {"verbose", 0, 0, 'V', "\tIncrease debug output"},
+        {"pid-file", 1, 0, 'p', "\t(Advanced) Daemon pid file location"},
+        {"foreground", 0, 0, 'f', "\tStart application in foreground"},
+        {"address", 1, 0, 'a', "\tAddress[%interface] to probe from the start (repeatable)"},
+        {NULL, 0, 0, 0}
+};
+
+void fencecheckd_init(void);
+void fencecheckd_finalize(void);
+
+/**
+ * SIGNAL handler function.
+ * @param nsig the number of SIGNAL.
+ */
+static void
+_fencecheckd_shutdown(int nsig)
+{
+    crm_debug("mainloop shutdown. SIGNAL is %d", nsig);
+    if (mainloop != NULL && g_main_loop_is_running(mainloop)) {
+        g_main_loop_quit(mainloop);
+        return;
+    }
+    fencecheckd_finalize();
+    unlink(pid_file);
+    free(pid_file);
+    crm_notice("Exiting %s", crm_system_name);
+    crm_exit(EX_OK);
+}
+
+/**
+ * Milliseconds since a monotonic time
+ * @param now the current monotonic time
+ * @param since the monotonic time, 0 if none
+ * @return the milliseconds, or -1 if since is 0
+ */
+static long long
+_msec_since(gint64 now,
+        gint64 since)
+{
+    if (since == 0) {
+        return -1;
+    }
+    return (long long) ((now - since) / 1000);
+}
+
+/**
+ * quorum notification function
+ * @see in detail about arguments, see corosync quorum API
+ */
+static void
+_cs_quorum_notify(quorum_handle_t handle,
+        uint32_t quorate,
+        uint64_t ring_seq,
+        uint32_t view_list_entries,
+        uint32_t *view_list)
+{
+    crm_debug("Quorum notification [quorate=%u, ring_seq=%llu, members=%u]",
+            quorate, (unsigned long long)ring_seq, view_list_entries);
+
+    if (q_state.known && q_state.quorate == quorate) {
+        return;
+    }
+    if (q_state.known) {
+        crm_notice("Quorum state changed [quorate=%u]", quorate);
+    }
+    q_state.known = TRUE;
+    q_state.quorate = quorate;
+    q_state.changed = g_get_monotonic_time();
+}
+
+/**
+ * quorum dispatch function
+ * @param user_data the gpointer of user data
+ * @return CS_OK is 0, otherwise, -1
+ */
+static int
+_cs_quorum_dispatch(gpointer user_data)
+{
+    cs_error_t rc = quorum_dispatch(q_state.handle, CS_DISPATCH_ALL);
+    if (rc != CS_OK) {
+        crm_debug("Failed to dispatch quorum: Error %d", rc);
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * quorum destroy function.
+ * The connection is retried while the quorum state is unknown.
+ * @param user_data the gpointer of user data
+ */
+static void
+_cs_quorum_destroy(gpointer user_data)
+{
+    q_state.source = NULL;
+    if (q_state.connected == FALSE) {
+        return;
+    }
+    crm_notice("Stop tracking quorum. quorum connection is destroyed");
+    q_state.connected = FALSE;
+    q_state.known = FALSE;
+    (void) quorum_finalize(q_state.handle);
+    fencecheckd_init();
+}
+
+/**
+ * Timeout function for connecting to the quorum service
+ * @return if connected, FALSE. otherwise, TRUE to retry.
+ */
+static gboolean
+_quorum_init(gpointer data)
+{
+    cs_error_t rc;
+    uint32_t quorum_type = 0;
+    int quorum_fd = 0;
+
+    static quorum_callbacks_t quorum_callbacks = {
+            .quorum_notify_fn = _cs_quorum_notify,
+    };
+    static struct mainloop_fd_callbacks quorum_fd_callbacks = {
+            .dispatch = _cs_quorum_dispatch,
+            .destroy = _cs_quorum_destroy,
+    };
+
+    rc = quorum_initialize(&q_state.handle, &quorum_callbacks, &quorum_type);
+    if (rc != CS_OK) {
+        crm_debug("Failed to initialize the quorum API. Error %d", rc);
+        return TRUE;
+    }
+
+    if (quorum_type != 1) {
+        crm_debug("Corosync quorum is not configured");
+        goto bail;
+    }
+
+    rc = quorum_fd_get(q_state.handle, &quorum_fd);
+    if (rc != CS_OK) {
+        crm_debug("Failed to get quorum fd. Error %d", rc);
+        goto bail;
+    }
+
+    q_state.source = mainloop_add_fd("corosync-quorum",
+            G_PRIORITY_DEFAULT,
+            quorum_fd,
+            &q_state.handle,
+            &quorum_fd_callbacks);
+    if (q_state.source == NULL) {
+        crm_debug("Failed to add quorum fd to mainloop");
+        goto bail;
+    }
+
+    rc = quorum_trackstart(q_state.handle, CS_TRACK_CURRENT | CS_TRACK_CHANGES);
+    if (rc != CS_OK) {
+        crm_debug("Failed to track quorum. Error %d", rc);
+        goto bail2;
+    }
+
+    q_state.connected = TRUE;
+    q_state.timer_id = 0;
+    crm_notice("Start to track quorum");
+    return FALSE;
+
+    bail2:
+    mainloop_del_fd(q_state.source);
+
+    bail:
+    (void) quorum_finalize(q_state.handle);
+    return TRUE;
+}
+
+/**
+ * Stop tracking quorum
+ */
+static void
+_quorum_finalize(void)
+{
+    if (q_state.timer_id != 0) {
+        g_source_remove(q_state.timer_id);
+        q_state.timer_id = 0;
+    }
+    if (q_state.connected == FALSE) {
+        return;
+    }
+    q_state.connected = FALSE;
+    q_state.known = FALSE;
+    (void) quorum_trackstop(q_state.handle);
+    if (q_state.source != NULL) {
+        mainloop_del_fd(q_state.source);
+    }
+    (void) quorum_finalize(q_state.handle);
+}
+
+/**
+ * Disconnect cmap.
+ * It is connected again at the next query.
+ */
+static void
+_cmap_disconnect(void)
+{
+    if (cmap_handle != 0) {
+        (void) cmap_finalize(cmap_handle);
+        cmap_handle = 0;
+    }
+}
+
+/**
+ * Get the membership of a node from the corosync membership
+ * @param host the node name
+ * @return FENCECHECKD_MEMBER_JOINED, FENCECHECKD_MEMBER_LEFT or
+ * FENCECHECKD_MEMBER_UNKNOWN
+ */
+static const char *
+_member_status(const char *host)
+{
+    enum cmap_member_state state;
+    uint32_t nodeid;
+    cs_error_t rc;
+
+    if (cmap_handle == 0) {
+        rc = cmap_initialize(&cmap_handle);
+        if (rc != CS_OK) {
+            crm_debug("Failed to initialize the cmap API. Error %d", rc);
+            cmap_handle = 0;
+            return FENCECHECKD_MEMBER_UNKNOWN;
+        }
+    }
+
+    /* the daemon does not wait for corosync, so nothing is retried */
+    rc = cmap_member_find_nodeid(cmap_handle, host, &nodeid, NULL);
+    if (rc == CS_ERR_NOT_EXIST) {
+        crm_debug("%s is not found in the nodelist", host);
+        return FENCECHECKD_MEMBER_UNKNOWN;
+    }
+    if (rc != CS_OK) {
+        crm_debug("Failed to search the nodelist. Error %d", rc);
+        if (rc != CS_ERR_TRY_AGAIN) {
+            _cmap_disconnect();
+        }
+        return FENCECHECKD_MEMBER_UNKNOWN;
+    }
+
+    rc = cmap_member_get_state(cmap_handle, nodeid, NULL, &state);
+    if (rc != CS_OK) {
+        crm_debug("Failed to get the membership of nodeid %u. Error %d", nodeid, rc);
+        return FENCECHECKD_MEMBER_UNKNOWN;
+    }
+    return state == CMAP_MEMBER_JOINED
+            ? FENCECHECKD_MEMBER_JOINED : FENCECHECKD_MEMBER_LEFT;
+}
+
+/**
+ * ICMP socket dispatch function
+ * @param user_data the target
+ * @return always 0
+ */
+static int
+_target_dispatch(gpointer user_data)
+{
+    struct fence_target *t = user_data;
+    uint16_t id, seq;
+    int rc;
+
+    while ((rc = icmp_probe_recv(t->fd, t->addr.ss_family, t->raw, &id, &seq)) >= 0) {
+        /* a ping socket rewrites the identifier by itself */
+        if (rc == 0 || (t->raw && id != probe_ident) || seq == 0 || seq > t->seq) {
+            continue;
+        }
+        t->last_reply = g_get_monotonic_time();
+        if (t->reachable == FALSE) {
+            t->reachable = TRUE;
+            crm_info("Target responded [%s]", t->spec);
+        }
+    }
+    return 0;
+}
+
+/**
+ * ICMP socket destroy function
+ * @param user_data the target
+ */
+static void
+_target_destroy(gpointer user_data)
+{
+    struct fence_target *t = user_data;
+
+    t->source = NULL;
+}
+
+/**
+ * Open the ICMP socket of a target and start to probe it
+ * @param t the target
+ * @return if the socket can be opened, TRUE. otherwise FALSE.
+ */
+static gboolean
+_target_open(struct fence_target *t)
+{
+    static struct mainloop_fd_callbacks target_fd_callbacks = {
+            .dispatch = _target_dispatch,
+            .destroy = _target_destroy,
+    };
+
+    t->fd = icmp_probe_open(&t->addr, t->addrlen, t->ifname, &t->raw);
+    if (t->fd < 0) {
+        /* log once, and retry at every probe */
+        if (t->failed == FALSE) {
+            crm_perror(LOG_ERR, "Could not open an ICMP socket for %s", t->spec);
+        }
+        t->failed = TRUE;
+        return FALSE;
+    }
+    t->source = mainloop_add_fd("fencecheckd-probe", G_PRIORITY_DEFAULT, t->fd, t,
+            &target_fd_callbacks);
+    if (t->source == NULL) {
+        crm_err("Failed to add the ICMP socket of %s to mainloop", t->spec);
+        close(t->fd);
+        t->fd = -1;
+        t->failed = TRUE;
+        return FALSE;
+    }
+    t->failed = FALSE;
+    t->probing_since = g_get_monotonic_time();
+    return TRUE;
+}
+
+/**
+ * Close the ICMP socket of a target
+ * @param t the target
+ */
+static void
+_target_close(struct fence_target *t)
+{
+    if (t->source != NULL) {
+        mainloop_del_fd(t->source);
+    }
+    if (t->fd >= 0) {
+        close(t->fd);
+        t->fd = -1;
+    }
+    t->probing_since = 0;
+}
+
+/**
+ * Find a target
+ * @param spec address[%interface]
+ * @return the target, or NULL if not found
+ */
+static struct fence_target *
+_target_find(const char *spec)
+{
+    int i;
+
+    for (i = 0; i < ntargets; i++) {
+        if (targets[i].spec != NULL && strcmp(targets[i].spec, spec) == 0) {
+            return &targets[i];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * Add a target and start to probe it
+ * @param spec address[%interface]
+ * @return the target, or NULL if it cannot be added
+ */
+static struct fence_target *
+_target_add(const char *spec)
+{
+    struct fence_target *t = NULL;
+    char *sep;
+    int rc;
+    int i;
+
+    /* a free slot keeps the others in place, mainloop refers to them */
+    for (i = 0; i < ntargets; i++) {
+        if (targets[i].spec == NULL) {
+            t = &targets[i];
+            break;
+        }
+    }
+    if (t == NULL) {
+        if (ntargets >= MAX_TARGETS) {
+            crm_warn("Too many targets, %s is not probed [max=%d]", spec, MAX_TARGETS);
+            return NULL;
+        }
+        t = &targets[ntargets];
+    }
+    memset(t, 0, sizeof(*t));
+    t->fd = -1;
+    t->spec = strdup(spec);
+    t->name = strdup(spec);
+    sep = strchr(t->name, TARGET_IF_SEPARATOR);
+    if (sep != NULL) {
+        *sep = '\0';
+        if (sep[1] != '\0') {
+            t->ifname = strdup(sep + 1);
+        }
+    }
+    /* a host name is not resolved, the lookup would block the queries */
+    rc = icmp_probe_resolve(t->name, t->ifname, &t->addr, &t->addrlen);
+    if (rc != 0) {
+        crm_err("Target is not an IP address : %s (%s)", spec, gai_strerror(rc));
+        goto bail;
+    }
+    if (t == &targets[ntargets]) {
+        ntargets++;
+    }
+    crm_info("Start to probe %s", spec);
+    (void) _target_open(t);
+    return t;
+
+    bail:
+    free(t->spec);
+    free(t->name);
+    free(t->ifname);
+    t->spec = NULL;
+    t->name = NULL;
+    t->ifname = NULL;
+    return NULL;
+}
+
+/**
+ * Stop to probe a target and free its slot
+ * @param t the target
+ */
+static void
+_target_remove(struct fence_target *t)
+{
+    _target_close(t);
+    free(t->spec);
+    free(t->name);
+    free(t->ifname);
+    t->spec = NULL;
+    t->name = NULL;
+    t->ifname = NULL;
+}
+
+/**
+ * Timeout function to send echo requests to all the targets
+ * @return always TRUE
+ */
+static gboolean
+_probe_tick(gpointer data)
+{
+    struct fence_target *t;
+    gint64 now = g_get_monotonic_time();
+    int i;
+
+    for (i = 0; i < ntargets; i++) {
+        t = &targets[i];
+        if (t->spec == NULL) {
+            continue;
+        }
+        if (t->configured == FALSE && _msec_since(now, t->last_query) > TARGET_EXPIRE_MSEC) {
+            crm_info("Stop to probe %s, it is not queried [expire=%ds]",
+                    t->spec, TARGET_EXPIRE_MSEC / 1000);
+            _target_remove(t);
+            continue;
+        }
+        if (t->fd < 0 && _target_open(t) == FALSE) {
+            continue;
+        }
+        t->seq++;
+        if (icmp_probe_send(t->fd, t->addr.ss_family, probe_ident, t->seq) < 0) {
+            switch (errno) {
+            case ENETUNREACH:
+            case EHOSTUNREACH:
+            case EHOSTDOWN:
+            case EAGAIN:
+                crm_trace("Could not send an echo request to %s: %s",
+                        t->spec, strerror(errno));
+                break;
+            default:
+                /* the probing time starts again with a new socket */
+                crm_perror(LOG_WARNING, "Could not send an echo request to %s", t->spec);
+                _target_close(t);
+                break;
+            }
+        }
+        if (t->reachable && _msec_since(now, t->last_reply) > TARGET_LOST_MSEC) {
+            t->reachable = FALSE;
+            crm_warn("Target does not respond [%s]", t->spec);
+        }
+    }
+    probe_last_tick = now;
+    return TRUE;
+}
+
+/**
+ * Answer a request
+ * @param c the client
+ */
+static void
+_client_reply(struct fence_client *c)
+{
+    struct fence_target *t;
+    GString *reply;
+    gint64 now = g_get_monotonic_time();
+    char *cmd, *host, *spec, *saveptr;
+    ssize_t len;
+
+    cmd = strtok_r(c->buf, TARGET_SEPARATORS, &saveptr);
+    if (cmd == NULL || strcmp(cmd, FENCECHECKD_CMD_VIEW) != 0) {
+        crm_warn("Unknown request: %s", cmd == NULL ? "" : cmd);
+        return;
+    }
+    host = strtok_r(NULL, TARGET_SEPARATORS, &saveptr);
+
+    reply = g_string_new(NULL);
+    g_string_append_printf(reply, FENCECHECKD_REPLY_VERSION_FORMAT, FENCECHECKD_VERSION);
+    g_string_append_printf(reply, FENCECHECKD_REPLY_QUORUM_FORMAT,
+            q_state.connected && q_state.known ? 1 : 0,
+            q_state.quorate ? 1 : 0,
+            q_state.known ? _msec_since(now, q_state.changed) : -1LL);
+    if (host != NULL) {
+        g_string_append_printf(reply, FENCECHECKD_REPLY_MEMBER_FORMAT,
+                host, _member_status(host));
+    }
+    while ((spec = strtok_r(NULL, TARGET_SEPARATORS, &saveptr)) != NULL) {
+        t = _target_find(spec);
+        if (t == NULL) {
+            t = _target_add(spec);
+        }
+        if (t == NULL) {
+            g_string_append_printf(reply, FENCECHECKD_REPLY_TARGET_FORMAT,
+                    spec, -1LL, -1LL, -1LL);
+            continue;
+        }
+        t->last_query = now;
+        g_string_append_printf(reply, FENCECHECKD_REPLY_TARGET_FORMAT,
+                t->spec,
+                _msec_since(now, t->probing_since),
+                _msec_since(now, t->last_reply),
+                _msec_since(now, probe_last_tick));
+    }
+    g_string_append(reply, FENCECHECKD_REPLY_END);
+
+    /* a reply is far smaller than the socket buffer */
+    len = send(c->fd, reply->str, reply->len, MSG_NOSIGNAL);
+    if (len != reply->len) {
+        crm_debug("Could not send a reply [len=%zd/%zu]", len, reply->len);
+    }
+    g_string_free(reply, TRUE);
+}
+
+/**
+ * client socket dispatch function.
+ * A client sends a request line, and is closed after the reply.
+ * @param user_data the client
+ * @return -1 to close the client, otherwise 0
+ */
+static int
+_client_dispatch(gpointer user_data)
+{
+    struct fence_client *c = user_data;
+    char *eol;
+    ssize_t len;
+
+    len = recv(c->fd, c->buf + c->len, sizeof(c->buf) - 1 - c->len, 0);
+    if (len < 0 && (errno == EAGAIN || errno == EINTR)) {
+        return 0;
+    }
+    if (len <= 0) {
+        return -1;
+    }
+    c->len += len;
+    c->buf[c->len] = '\0';
+
+    eol = strchr(c->buf, '\n');
+    if (eol == NULL) {
+        if (c->len >= sizeof(c->buf) - 1) {
+            crm_warn("Too long request [len=%zu]", c->len);
+            return -1;
+        }
+        return 0;
+    }
+    *eol = '\0';
+    _client_reply(c);
+    return -1;
+}
+
+/**
+ * client socket destroy function
+ * @param user_data the client
+ */
+static void
+_client_destroy(gpointer user_data)
+{
+    struct fence_client *c = user_data;
+
+    close(c->fd);
+    free(c);
+}
+
+/**
+ * query socket dispatch function
+ * @param user_data the gpointer of user data
+ * @return always 0
+ */
+static int
+_server_dispatch(gpointer user_data)
+{
+    struct fence_client *c;
+    int fd;
+
+    static struct mainloop_fd_callbacks client_fd_callbacks = {
+            .dispatch = _client_dispatch,
+            .destroy = _client_destroy,
+    };
+
+    while ((fd = accept(server_fd, NULL, NULL)) >= 0) {
+        c = calloc(1, sizeof(*c));
+        if (c == NULL
+                || fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK) != 0
+                || fcntl(fd, F_SETFD, FD_CLOEXEC) != 0) {
+            close(fd);
+            free(c);
+            continue;
+        }
+        c->fd = fd;
+        /* a query is in the middle of fencing, so it goes first */
+        c->source = mainloop_add_fd("fencecheckd-client", G_PRIORITY_HIGH, fd, c,
+                &client_fd_callbacks);
+        if (c->source == NULL) {
+            crm_debug("Failed to add a client to mainloop");
+            close(fd);
+            free(c);
+        }
+    }
+    return 0;
+}
+
+/**
+ * query socket destroy function
+ * @param user_data the gpointer of user data
+ */
+static void
+_server_destroy(gpointer user_data)
+{
+    server_source = NULL;
+}
+
+/**
+ * Create the query socket and add it to mainloop
+ * @return if the socket can be created, TRUE. otherwise FALSE.
+ */
+static gboolean
+_server_init(void)
+{
+    struct sockaddr_un addr;
+    mode_t old_umask;
+    int rc;
+
+    static struct mainloop_fd_callbacks server_fd_callbacks = {
+            .dispatch = _server_dispatch,
+            .destroy = _server_destroy,
+    };
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    snprintf(addr.sun_path, sizeof(addr.sun_path), "%s", FENCECHECKD_SOCKET);
+    unlink(FENCECHECKD_SOCKET);
+
+    server_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (server_fd < 0) {
+        crm_perror(LOG_ERR, "Could not open the query socket");
+        return FALSE;
+    }
+
+    /* only root queries the state */
+    old_umask = umask(0077);
+    rc = bind(server_fd, (struct sockaddr *) &addr, sizeof(addr));
+    umask(old_umask);
+    if (rc != 0) {
+        crm_perror(LOG_ERR, "Could not bind the query socket to %s", FENCECHECKD_SOCKET);
+        goto bail;
+    }
+    if (listen(server_fd, SERVER_BACKLOG) != 0) {
+        crm_perror(LOG_ERR, "Could not listen on %s", FENCECHECKD_SOCKET);
+        goto bail;
+    }
+
+    server_source = mainloop_add_fd("fencecheckd-server", G_PRIORITY_HIGH, server_fd,
+            NULL, &server_fd_callbacks);
+    if (server_source == NULL) {
+        crm_err("Failed to add the query socket to mainloop");
+        goto bail;
+    }
+    return TRUE;
+
+    bail:
+    close(server_fd);
+    server_fd = -1;
+    unlink(FENCECHECKD_SOCKET);
+    return FALSE;
+}
+
+/**
+ * Close and remove the query socket
+ */
+static void
+_server_finalize(void)
+{
+    if (server_source != NULL) {
+        mainloop_del_fd(server_source);
+    }
+    if (server_fd >= 0) {
+        close(server_fd);
+        server_fd = -1;
+        unlink(FENCECHECKD_SOCKET);
+    }
+}
+
+/**
+ * Start to probe the targets given by the options
+ */
+static void
+_probe_init(void)
+{
+    struct fence_target *t;
+    char *spec, *saveptr;
+
+    probe_ident = (uint16_t) getpid();
+    if (opt_targets != NULL) {
+        for (spec = strtok_r(opt_targets, TARGET_SEPARATORS, &saveptr); spec != NULL;
+                spec = strtok_r(NULL, TARGET_SEPARATORS, &saveptr)) {
+            t = _target_find(spec);
+            if (t == NULL) {
+                t = _target_add(spec);
+            }
+            if (t != NULL) {
+                t->configured = TRUE;
+            }
+        }
+    }
+    probe_last_tick = g_get_monotonic_time();
+    _probe_tick(NULL);
+    probe_timer_id = g_timeout_add(PROBE_INTERVAL_MSEC, _probe_tick, NULL);
+}
+
+/**
+ * Stop probing and free the targets
+ */
+static void
+_probe_finalize(void)
+{
+    int i;
+
+    if (probe_timer_id != 0) {
+        g_source_remove(probe_timer_id);
+        probe_timer_id = 0;
+    }
+    for (i = 0; i < ntargets; i++) {
+        _target_remove(&targets[i]);
+    }
+    ntargets = 0;
+}
+
+/**
+ * Finalize deamon.
+ */
+void
+fencecheckd_finalize(void)
+{
+    _server_finalize();
+    _probe_finalize();
+    _quorum_finalize();
+    _cmap_disconnect();
+}
+
+/**
+ * Add the connection function of the quorum service to mainloop.
+ */
+void
+fencecheckd_init(void)
+{
+    crm_debug("Start to regularly connect to the quorum service [interval %u(s)]",
+            DEFAULT_INTERVAL);
+    if (q_state.timer_id != 0) {
+        crm_debug("The timer already existed");
+        return;
+    }
+    q_state.timer_id = g_timeout_add_seconds(DEFAULT_INTERVAL, _quorum_init, NULL);
+}
+
+/**
+ * Main function
+ * @return if normal exit, 0
+ */
+int
+main(int argc, char **argv)
+{
+    const char *crm_system_name = DEFAULT_SYS_NAME;
+    int option_index = 0;
+    int flag;
+    char *joined;
+    conf[FC_CH_FG] = FALSE;
+    pid_file = strdup(PID_FILE);
+
+    crm_log_init(crm_system_name,
+            LOG_INFO,
+            TRUE,
+            FALSE,
+            argc,
+            argv,
+            FALSE);
+    crm_set_options(NULL,
+            "[options]",
+            long_options,
+            "Daemon for keeping quorum, membership and reachability for stonith-helper");
+
+    while (1) {
+        flag = crm_get_option(argc, argv, &option_index);
+        if (flag == -1)
+            break;
+
+        switch (flag) {
+        case 'V':
+            crm_bump_log_level(argc, argv);
+            break;
+        case 'f':
+            conf[FC_CH_FG] = TRUE;
+            break;
+        case 'p':
+            free(pid_file);
+            pid_file = strdup(optarg);
+            break;
+        case 'a':
+            joined = opt_targets == NULL ? g_strdup(optarg)
+                    : g_strconcat(opt_targets, ",", optarg, NULL);
+            g_free(opt_targets);
+            opt_targets = joined;
+            break;
+        case '?':
+        case '$':
+            crm_help(flag, EX_OK);
+            break;
+        default:
+            crm_help(flag, EX_USAGE);
+            break;
+        }
+    }
+
+    if (conf[FC_CH_FG] == FALSE) {
+        crm_make_daemon(crm_system_name, TRUE, pid_file);
+    } else {
+        int pid;
+        int rc;
+        rc = crm_pidfile_inuse(pid_file, 1);
+        if (rc < pcmk_ok && rc != -ENOENT) {
+            pid = crm_read_pidfile(pid_file);
+            crm_err("%s: already running [pid %d in %s]", crm_system_name, pid, pid_file);
+            free(pid_file);
+            crm_exit(rc);
+        } else {
+            rc = crm_lock_pidfile(pid_file);
+            if (rc < pcmk_ok) {
+                crm_err("Could not lock '%s' for %s: %s (%d)", pid_file, crm_system_name, pcmk_strerror(rc), rc);
+                free(pid_file);
+                crm_exit(rc);
+            }
+        }
+    }
+
+    crm_notice("Starting %s", crm_system_name);
+
+    mainloop = g_main_loop_new(NULL, FALSE);
+    mainloop_add_signal(SIGTERM, _fencecheckd_shutdown);
+    mainloop_add_signal(SIGINT, _fencecheckd_shutdown);
+
+    if (_server_init() == FALSE) {
+        unlink(pid_file);
+        free(pid_file);
+        crm_exit(EX_OSERR);
+    }
+    _probe_init();
+    fencecheckd_init();
+    g_main_loop_run(mainloop);
+
+    fencecheckd_finalize();
+    g_free(opt_targets);
+    unlink(pid_file);
+    free(pid_file);
+    crm_notice("Exiting %s", crm_system_name);
+    return crm_exit(EX_OK);
+}
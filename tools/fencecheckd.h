@@ -0,0 +1,71 @@
+/*
+ * fencecheckd.h - Query protocol of fencecheckd
+ *
+ * Copyright (C) 2026 NIPPON TELEGRAPH AND TELEPHONE CORPORATION
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef FENCECHECKD_H
+#define FENCECHECKD_H
+
+/**
+ * query socket path
+ * (fencecheckd creates it and removes it on exit)
+ */
+#define FENCECHECKD_SOCKET "/var/run/fencecheckd.sock"
+
+/**
+ * version of the query protocol
+ * (incremented when the reply changes incompatibly)
+ */
+#define FENCECHECKD_VERSION 1
+
+/**
+ * max length of a request line
+ */
+#define FENCECHECKD_REQUEST_LEN 4096
+
+/**
+ * request: "view <host> [address[%interface] ...]\n"
+ * An address which fencecheckd does not probe yet is added to its
+ * targets, and is reported as not probed this time.
+ */
+#define FENCECHECKD_CMD_VIEW "view"
+
+/**
+ * reply lines, in this order.
+ * The times are milliseconds before the reply, -1 if there is none.
+ */
+/** "fencecheckd <version>" */
+#define FENCECHECKD_REPLY_VERSION_FORMAT "fencecheckd %u\n"
+/** "quorum <connected(0/1)> <quorate(0/1)> <since the last change>" */
+#define FENCECHECKD_REPLY_QUORUM_FORMAT "quorum %d %d %lld\n"
+/** "member <host> <joined|left|unknown>" */
+#define FENCECHECKD_REPLY_MEMBER_FORMAT "member %s %s\n"
+/** "target <address> <probing time> <since the last reply> <since the last probe>" */
+#define FENCECHECKD_REPLY_TARGET_FORMAT "target %s %lld %lld %lld\n"
+/** the end of a reply */
+#define FENCECHECKD_REPLY_END "end\n"
+
+/**
+ * member states in a reply
+ */
+#define FENCECHECKD_MEMBER_JOINED "joined"
+#define FENCECHECKD_MEMBER_LEFT "left"
+#define FENCECHECKD_MEMBER_UNKNOWN "unknown"
+
+#endif /* FENCECHECKD_H */
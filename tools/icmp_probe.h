@@ -0,0 +1,256 @@
+/*
+ * icmp_probe.h - ICMP echo sockets shared by pm_helper and fencecheckd
+ *
+ * Copyright (C) 2026 NIPPON TELEGRAPH AND TELEPHONE CORPORATION
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef ICMP_PROBE_H
+#define ICMP_PROBE_H
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <errno.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <netdb.h>
+#include <net/if.h>
+#include <netinet/in.h>
+#include <netinet/ip.h>
+#include <netinet/ip_icmp.h>
+#include <netinet/icmp6.h>
+
+/**
+ * payload size of an echo request(same as ping)
+ */
+#define ICMP_PROBE_DATA_LEN 56
+
+/**
+ * receive buffer size for an echo reply
+ */
+#define ICMP_PROBE_RECV_LEN 1500
+
+/**
+ * Compute the internet checksum of an ICMP message
+ * @param data the message
+ * @param len the length of the message
+ * @return the checksum
+ */
+static inline uint16_t
+icmp_probe_checksum(const void *data,
+        size_t len)
+{
+    const uint16_t *p = data;
+    uint32_t sum = 0;
+
+    for (; len > 1; len -= 2) {
+        sum += *p++;
+    }
+    if (len == 1) {
+        sum += *(const uint8_t *) p;
+    }
+    sum = (sum >> 16) + (sum & 0xffff);
+    sum += (sum >> 16);
+    return (uint16_t) ~sum;
+}
+
+/**
+ * Resolve a probed address.
+ * Only a numeric address is accepted, so that a probe never waits for DNS.
+ * A link-local IPv6 address gets the scope of the interface.
+ * @param name the address without the interface
+ * @param ifname the interface, or NULL
+ * @param addr the resolved address
+ * @param addrlen the length of addr
+ * @return 0 if resolved, otherwise the error of getaddrinfo
+ */
+static inline int
+icmp_probe_resolve(const char *name,
+        const char *ifname,
+        struct sockaddr_storage *addr,
+        socklen_t *addrlen)
+{
+    struct addrinfo hints, *res;
+    int rc;
+
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = strchr(name, ':') != NULL ? AF_INET6 : AF_INET;
+    hints.ai_socktype = SOCK_RAW;
+    hints.ai_flags = AI_NUMERICHOST;
+    rc = getaddrinfo(name, NULL, &hints, &res);
+    if (rc != 0) {
+        return rc;
+    }
+    memcpy(addr, res->ai_addr, res->ai_addrlen);
+    *addrlen = res->ai_addrlen;
+    freeaddrinfo(res);
+
+    if (ifname != NULL && addr->ss_family == AF_INET6) {
+        struct sockaddr_in6 *sin6 = (struct sockaddr_in6 *) addr;
+
+        if (IN6_IS_ADDR_LINKLOCAL(&sin6->sin6_addr)) {
+            sin6->sin6_scope_id = if_nametoindex(ifname);
+        }
+    }
+    return 0;
+}
+
+/**
+ * Open a non-blocking ICMP socket which receives from an address only.
+ * A raw socket is used if it is permitted, otherwise a ping socket.
+ * @param addr the probed address
+ * @param addrlen the length of addr
+ * @param ifname the interface to send from, or NULL
+ * @param raw set to 1 if the socket is a raw socket, 0 if a ping socket
+ * @return the socket, or -1 with errno
+ */
+static inline int
+icmp_probe_open(const struct sockaddr_storage *addr,
+        socklen_t addrlen,
+        const char *ifname,
+        int *raw)
+{
+    int family = addr->ss_family;
+    int proto = family == AF_INET6 ? IPPROTO_ICMPV6 : IPPROTO_ICMP;
+    int fd;
+    int err;
+
+    *raw = 1;
+    fd = socket(family, SOCK_RAW | SOCK_NONBLOCK | SOCK_CLOEXEC, proto);
+    if (fd < 0 && (errno == EPERM || errno == EACCES)) {
+        *raw = 0;
+        fd = socket(family, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, proto);
+    }
+    if (fd < 0) {
+        return -1;
+    }
+
+    if (ifname != NULL
+            && setsockopt(fd, SOL_SOCKET, SO_BINDTODEVICE,
+                    ifname, strlen(ifname) + 1) != 0) {
+        goto bail;
+    }
+
+    if (*raw && family == AF_INET6) {
+        struct icmp6_filter filter;
+
+        ICMP6_FILTER_SETBLOCKALL(&filter);
+        ICMP6_FILTER_SETPASS(ICMP6_ECHO_REPLY, &filter);
+        (void) setsockopt(fd, IPPROTO_ICMPV6, ICMP6_FILTER,
+                &filter, sizeof(filter));
+    }
+
+    /* receive the replies from the address only */
+    if (connect(fd, (const struct sockaddr *) addr, addrlen) != 0) {
+        goto bail;
+    }
+    return fd;
+
+    bail:
+    err = errno;
+    close(fd);
+    errno = err;
+    return -1;
+}
+
+/**
+ * Send an echo request
+ * @param fd the ICMP socket
+ * @param family the address family of the socket
+ * @param ident the identifier of the echo request
+ * @param seq the sequence number of the echo request
+ * @return the result of send
+ */
+static inline ssize_t
+icmp_probe_send(int fd,
+        int family,
+        uint16_t ident,
+        uint16_t seq)
+{
+    union {
+        struct icmphdr v4;
+        struct icmp6_hdr v6;
+        uint8_t buf[sizeof(struct icmphdr) + ICMP_PROBE_DATA_LEN];
+    } packet;
+
+    memset(&packet, 0, sizeof(packet));
+    if (family == AF_INET6) {
+        packet.v6.icmp6_type = ICMP6_ECHO_REQUEST;
+        packet.v6.icmp6_id = htons(ident);
+        packet.v6.icmp6_seq = htons(seq);
+    } else {
+        packet.v4.type = ICMP_ECHO;
+        packet.v4.un.echo.id = htons(ident);
+        packet.v4.un.echo.sequence = htons(seq);
+        packet.v4.checksum = icmp_probe_checksum(&packet, sizeof(packet));
+    }
+    return send(fd, &packet, sizeof(packet), 0);
+}
+
+/**
+ * Receive a packet and check whether it is an echo reply
+ * @param fd the ICMP socket
+ * @param family the address family of the socket
+ * @param raw 1 if the socket is a raw socket
+ * @param ident the identifier of the echo reply
+ * (a ping socket rewrites it by itself)
+ * @param seq the sequence number of the echo reply
+ * @return 1 if an echo reply is received, 0 if another packet,
+ * -1 if nothing is received
+ */
+static inline int
+icmp_probe_recv(int fd,
+        int family,
+        int raw,
+        uint16_t *ident,
+        uint16_t *seq)
+{
+    uint8_t buf[ICMP_PROBE_RECV_LEN];
+    ssize_t len;
+    size_t hlen = 0;
+
+    len = recv(fd, buf, sizeof(buf), 0);
+    if (len <= 0) {
+        return -1;
+    }
+    if (family == AF_INET6) {
+        struct icmp6_hdr *icmp6 = (struct icmp6_hdr *) buf;
+
+        if (len < sizeof(*icmp6) || icmp6->icmp6_type != ICMP6_ECHO_REPLY) {
+            return 0;
+        }
+        *ident = ntohs(icmp6->icmp6_id);
+        *seq = ntohs(icmp6->icmp6_seq);
+    } else {
+        struct icmphdr *icmp;
+
+        /* a raw socket receives the IP header too */
+        if (raw) {
+            hlen = ((struct iphdr *) buf)->ihl * 4;
+        }
+        icmp = (struct icmphdr *) (buf + hlen);
+        if (len < hlen + sizeof(*icmp) || icmp->type != ICMP_ECHOREPLY) {
+            return 0;
+        }
+        *ident = ntohs(icmp->un.echo.id);
+        *seq = ntohs(icmp->un.echo.sequence);
+    }
+    return 1;
+}
+
+#endif /* ICMP_PROBE_H */
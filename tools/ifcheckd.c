@@ -21,7 +21,14 @@
 
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <sys/socket.h>
+#include <sys/mman.h>
 #include <unistd.h>
+#include <ifaddrs.h>
+#include <net/if.h>
+#include <arpa/inet.h>
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
 
 #include <corosync/cfg.h>
 #include <corosync/cmap.h>
@@ -30,6 +37,9 @@
 #include <crm/common/mainloop.h>
 #include <crm_internal.h>
 
+#include "ifcheckd_shm.h"
+#include "pidfile.h"
+
 /**
  * default system name
  * (normally, execute file name)
@@ -68,11 +78,6 @@
  */
 #define MAX_LENGTH 255
 
-/**
- * a max buffer size of pid file
- */
-#define LOCKSTRLEN  11
-
 /**
  * default wait time(seconds)
  */
@@ -124,6 +129,91 @@
  */
 #define ATTR_VALUE_FORMAT "%s is %s"
 
+/**
+ * numeric ring state attribute name format
+ * (1 is UP, 0 is FAULTY or UNKOWN)
+ */
+#define ATTR_RINGSTATE_NAME_FORMAT "ringstate_%u"
+
+/**
+ * attribute name of the number of UP rings
+ */
+#define ATTR_HEALTHY_COUNT_NAME "ring_healthy_count"
+
+/**
+ * attribute name of the number of rings
+ */
+#define ATTR_TOTAL_COUNT_NAME "ring_total_count"
+
+/**
+ * numeric attribute value format
+ */
+#define ATTR_NUMBER_FORMAT "%u"
+
+/**
+ * max number of rings
+ * (same as the max number of knet links)
+ */
+#define MAX_RINGS 8
+
+/**
+ * carrier attribute name format
+ */
+#define ATTR_CARRIER_NAME_FORMAT "ringcarrier_%u"
+
+/**
+ * carrier state which the kernel reports
+ */
+#define CARRIER_UP "UP"
+#define CARRIER_LOST "LOST"
+
+/**
+ * rtnetlink multicast groups to watch
+ */
+#define RTNL_GROUPS (RTMGRP_LINK | RTMGRP_IPV4_IFADDR | RTMGRP_IPV6_IFADDR)
+
+/**
+ * receive buffer size for rtnetlink messages
+ */
+#define RTNL_RECV_LEN 8192
+
+/**
+ * priority of the ring events (cmap and rtnetlink)
+ * They are dispatched before any background work that is ready.
+ */
+#define RING_EVENT_PRIORITY G_PRIORITY_HIGH
+
+/**
+ * priority of the background work (initialization, resync and cleanup
+ * of the attributes)
+ */
+#define BACKGROUND_PRIORITY G_PRIORITY_LOW
+
+/**
+ * time budget of a step of the background work(milliseconds)
+ * A step ends after the ring which exceeded it.
+ */
+#define BACKGROUND_STEP_BUDGET_MSEC 20
+
+/**
+ * interval of the background work while cmap is busy(milliseconds)
+ */
+#define BACKGROUND_BUSY_INTERVAL_MSEC 1000
+
+/**
+ * a ring event dispatched within this after a background step may have
+ * waited for the step(microseconds)
+ */
+#define STEP_ADJACENT_USEC 1000
+
+/**
+ * expected upper bound of the latency from a faulty notification to the
+ * attribute update(milliseconds)
+ * It is one background step, one attrd round trip for each attribute and
+ * the corosync queries. A longer latency is logged.
+ */
+#define PUBLISH_LATENCY_BOUND_MSEC 500
+
 /**
  * kind of configure
  */
@@ -132,6 +222,34 @@ enum {
     IF_CH_MAX
 };
 
+/**
+ * kernel interface of a ring structure
+ */
+struct ring_link {
+    char addr[INET6_ADDRSTRLEN]; /**< ring bind address */
+    unsigned int ifindex; /**< interface index, 0 if not found */
+    gboolean known; /**< TRUE after the carrier was published */
+    gboolean carrier; /**< TRUE if the carrier is up */
+};
+
+/**
+ * attribute work structure
+ * All attributes relating to ring number are updated or deleted ring by
+ * ring in the background.
+ */
+struct attr_work {
+    guint source_id; /**< idle source id, 0 if not running */
+    gboolean delete; /**< TRUE to delete the attributes, FALSE to update */
+    corosync_cfg_handle_t cfg_handle; /**< cfg handle while running */
+    cmap_handle_t cmap_handle; /**< cmap handle to read the faulty keys */
+    unsigned int interface_count; /**< the number of rings */
+    char **interface_names; /**< the address of each ring */
+    char **interface_status; /**< the status of each ring */
+    unsigned int next; /**< the next ring to work on */
+    unsigned int total; /**< the number of rings updated by the work */
+    unsigned int busy; /**< the number of steps cmap was busy in a row */
+};
+
 /**
  * wait time structure
  */
@@ -176,6 +294,45 @@ static mainloop_io_t* cmap_source;
  */
 static struct wait_time w_timer;
 
+/**
+ * the number of rings, and whether each ring is UP
+ */
+static unsigned int ring_total;
+static gboolean ring_healthy[MAX_RINGS];
+
+/**
+ * kernel interface of each ring
+ */
+static struct ring_link ring_links[MAX_RINGS];
+
+/**
+ * rtnetlink socket and its fd source
+ */
+static int rtnl_fd = -1;
+static mainloop_io_t *rtnl_source;
+
+/**
+ * mapped state file for local consumers
+ */
+static struct ifcheckd_shm *shm_state;
+
+/**
+ * running attribute work
+ */
+static struct attr_work attr_work;
+
+/**
+ * the last background step [start, end] (monotonic, microseconds)
+ */
+static gint64 step_start;
+static gint64 step_end;
+
+/**
+ * the time since which the current faulty notification may have waited
+ * (monotonic, microseconds)
+ */
+static gint64 publish_since;
+
 /**
  * options index
  */
@@ -196,123 +353,10 @@ static gboolean attr_options = FALSE;
 
 void ifcheckd_init(void);
 void ifcheckd_finalize(void);
-
-/**
- * this function is used when the program is executed as foreground
- * (this is equal to the same name of function in utile.c)
- */
-static int
-crm_pidfile_inuse(const char *filename, long mypid)
-{
-    long pid = 0;
-    struct stat sbuf;
-    char buf[LOCKSTRLEN + 1];
-    int rc = -ENOENT, fd = 0;
-
-    if ((fd = open(filename, O_RDONLY)) >= 0) {
-        if (fstat(fd, &sbuf) >= 0 && sbuf.st_size < LOCKSTRLEN) {
-            sleep(2);           /* if someone was about to create one,
-                                 * give'm a sec to do so
-                                 */
-        }
-        if (read(fd, buf, sizeof(buf)) > 0) {
-            if (sscanf(buf, "%lu", &pid) > 0) {
-                crm_trace("Got pid %lu from %s\n", pid, filename);
-                if (pid <= 1) {
-                    /* Invalid pid */
-                    rc = -ENOENT;
-                    unlink(filename);
-
-                } else if (mypid && pid == mypid) {
-                    /* In use by us */
-                    rc = pcmk_ok;
-
-                } else if (crm_pid_active(pid) == FALSE) {
-                    /* Contains a stale value */
-                    unlink(filename);
-                    rc = -ENOENT;
-
-                } else if (mypid && pid != mypid) {
-                    /* locked by existing process - give up */
-                    rc = -EEXIST;
-                }
-            }
-        }
-        close(fd);
-    }
-    return rc;
-}
-
-/**
- * this function is used when the program is executed as foreground
- * (this is equal to the same name of function in utile.c)
- */
-static int
-crm_read_pidfile(const char *filename)
-{
-    int fd;
-    long pid = -1;
-    char buf[LOCKSTRLEN + 1];
-
-    if ((fd = open(filename, O_RDONLY)) < 0) {
-        goto bail;
-    }
-
-    if (read(fd, buf, sizeof(buf)) < 1) {
-        goto bail;
-    }
-
-    if (sscanf(buf, "%lu", &pid) > 0) {
-        if (pid <= 0) {
-            pid = -ESRCH;
-        }
-    }
-
-  bail:
-    if (fd >= 0) {
-        close(fd);
-    }
-    return pid;
-}
-
-/**
- * this function is used the program is executed as foreground
- * (this is equal to the same name of function in utile.c)
- */
-static int
-crm_lock_pidfile(const char *filename)
-{
-    long mypid = 0;
-    int fd = 0, rc = 0;
-    char buf[LOCKSTRLEN + 1];
-
-    mypid = (unsigned long)getpid();
-
-    rc = crm_pidfile_inuse(filename, 0);
-    if (rc == -ENOENT) {
-        /* exists but the process is not active */
-
-    } else if (rc != pcmk_ok) {
-        /* locked by existing process - give up */
-        return rc;
-    }
-
-    if ((fd = open(filename, O_CREAT | O_WRONLY | O_EXCL, 0644)) < 0) {
-        /* Hmmh, why did we fail? Anyway, nothing we can do about it */
-        return -errno;
-    }
-
-    snprintf(buf, sizeof(buf), "%*lu\n", LOCKSTRLEN - 1, mypid);
-    rc = write(fd, buf, LOCKSTRLEN);
-    close(fd);
-
-    if (rc != LOCKSTRLEN) {
-        crm_perror(LOG_ERR, "Incomplete write to %s", filename);
-        return -errno;
-    }
-
-    return crm_pidfile_inuse(filename, mypid);
-}
+static void _shm_finalize(void);
+static void _attr_resync_done(gboolean synced);
+static gboolean _attr_work_step(gpointer user_data);
+static void _ifcheckd_stop(gboolean background);
 
 /**
  * "runtime.connections.pacemakerd" key search function.
@@ -370,6 +414,7 @@ _ifcheckd_shutdown(int nsig)
         return;
     }
     ifcheckd_finalize();
+    _shm_finalize();
     unlink(pid_file);
     free(pid_file);
     crm_notice("Exiting %s", crm_system_name);
@@ -384,7 +429,14 @@ _ifcheckd_shutdown(int nsig)
 static int
 _cs_cmap_dispatch(gpointer user_data)
 {
-    cs_error_t rc = cmap_dispatch(cmap_handle, CS_DISPATCH_ONE);
+    cs_error_t rc;
+
+    /* the notification may have waited for the background step just before */
+    publish_since = g_get_monotonic_time();
+    if (publish_since - step_end < STEP_ADJACENT_USEC) {
+        publish_since = step_start;
+    }
+    rc = cmap_dispatch(cmap_handle, CS_DISPATCH_ONE);
     if (rc != CS_OK) {
         crm_debug("Failed to dispatch cmap: Error %d", rc);
         return -1;
@@ -400,7 +452,7 @@ static void
 _cs_cmap_destroy(gpointer user_data)
 {
     crm_notice("Stop monitoring interface. cmap connection is destroyed");
-    ifcheckd_finalize();
+    _ifcheckd_stop(TRUE);
     /* run init when corosync stopped */
     ifcheckd_init();
 }
@@ -435,41 +487,540 @@ _delete_attr_iface(uint32_t iface_no,
 }
 
 /**
- * Update a specified attribute by ring number
- * @param iface_no the ring number
- * @param interface_name the string of ip
- * @param state the string of ring link status
- * @param size the length of attribute name and attribute value
- * @return if a attribute can be updated, TRUE. otherwise, FALSE
+ * Update a specified attribute by ring number
+ * @param iface_no the ring number
+ * @param interface_name the string of ip
+ * @param state the string of ring link status
+ * @param size the length of attribute name and attribute value
+ * @return if a attribute can be updated, TRUE. otherwise, FALSE
+ */
+static gboolean
+_update_attr_iface(uint32_t iface_no,
+        const char *interface_name,
+        const char *state,
+        size_t size)
+{
+    char if_attr[size];
+    char if_value[size];
+    const char *attr_section = NULL;
+    const char *attr_set = NULL;
+    int len = -1;
+
+    len = snprintf(if_attr, size, ATTR_NAME_FORMAT, iface_no);
+    if (!(-1 < len && len < size)) {
+        crm_debug("Failed to copy ring number: len=%d", len);
+        return FALSE;
+    }
+    len = snprintf(if_value, size, ATTR_VALUE_FORMAT, interface_name, state);
+    if (!(-1 < len && len < size)) {
+        crm_debug("Failed to copy interface name: len=%d", len);
+        return FALSE;
+    }
+    if (attrd_update_delegate(NULL, 'U', NULL, if_attr, if_value,
+                    attr_section, attr_set, NULL, NULL, attr_options) != pcmk_ok) {
+        crm_debug("Could not update %s=%s", if_attr, if_value);
+        return FALSE;
+    }
+    return TRUE;
+}
+
+/**
+ * Update or delete an attribute by name
+ * @param attr the attribute name
+ * @param value the attribute value, or NULL to delete the attribute
+ * @return if a attribute can be updated, TRUE. otherwise, FALSE
+ */
+static gboolean
+_update_attr_value(const char *attr,
+        const char *value)
+{
+    const char *attr_section = NULL;
+    const char *attr_set = NULL;
+    char command = value == NULL ? 'D' : 'U';
+
+    if (attrd_update_delegate(NULL, command, NULL, attr, value,
+                    attr_section, attr_set, NULL, NULL, attr_options) != pcmk_ok) {
+        crm_debug("Could not %s %s", value == NULL ? "delete" : "update", attr);
+        return FALSE;
+    }
+    return TRUE;
+}
+
+/**
+ * Create and map the state file.
+ * A file left by a killed ifcheckd is removed, since its generation may
+ * be stuck at odd. ifcheckd works without it, so a failure is only logged.
+ */
+static void
+_shm_init(void)
+{
+    int fd;
+
+    if (unlink(IFCHECKD_SHM_FILE) != 0 && errno != ENOENT) {
+        crm_perror(LOG_ERR, "Could not remove %s", IFCHECKD_SHM_FILE);
+        return;
+    }
+    fd = open(IFCHECKD_SHM_FILE, O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        crm_perror(LOG_ERR, "Could not open %s", IFCHECKD_SHM_FILE);
+        return;
+    }
+    if (ftruncate(fd, sizeof(struct ifcheckd_shm)) != 0) {
+        crm_perror(LOG_ERR, "Could not resize %s", IFCHECKD_SHM_FILE);
+        close(fd);
+        return;
+    }
+    shm_state = mmap(NULL, sizeof(struct ifcheckd_shm), PROT_READ | PROT_WRITE,
+            MAP_SHARED, fd, 0);
+    close(fd);
+    if (shm_state == MAP_FAILED) {
+        crm_perror(LOG_ERR, "Could not map %s", IFCHECKD_SHM_FILE);
+        shm_state = NULL;
+        return;
+    }
+
+    ifcheckd_shm_write_begin(shm_state);
+    shm_state->pid = getpid();
+    shm_state->version = IFCHECKD_SHM_VERSION;
+    shm_state->magic = IFCHECKD_SHM_MAGIC;
+    ifcheckd_shm_write_end(shm_state);
+}
+
+/**
+ * Write a ring to the state file
+ * @param iface_no the ring number
+ * @param state the string of ring link status, or NULL to keep it
+ */
+static void
+_shm_update_ring(uint32_t iface_no,
+        const char *state)
+{
+    struct ifcheckd_shm_ring *ring;
+    uint32_t new_state;
+    uint32_t new_carrier;
+
+    if (shm_state == NULL || iface_no >= IFCHECKD_SHM_MAX_RINGS
+            || iface_no >= MAX_RINGS) {
+        return;
+    }
+    ring = &shm_state->rings[iface_no];
+
+    if (state == NULL) {
+        new_state = ring->state;
+    } else if (strcmp(state, STATE_UP) == 0) {
+        new_state = IFCHECKD_SHM_STATE_UP;
+    } else if (strcmp(state, STATE_FAULTY) == 0) {
+        new_state = IFCHECKD_SHM_STATE_FAULTY;
+    } else {
+        new_state = IFCHECKD_SHM_STATE_UNKNOWN;
+    }
+    if (ring_links[iface_no].known == FALSE) {
+        new_carrier = IFCHECKD_SHM_CARRIER_UNKNOWN;
+    } else if (ring_links[iface_no].carrier) {
+        new_carrier = IFCHECKD_SHM_CARRIER_UP;
+    } else {
+        new_carrier = IFCHECKD_SHM_CARRIER_LOST;
+    }
+
+    ifcheckd_shm_write_begin(shm_state);
+    if (ring->state != new_state || ring->carrier != new_carrier) {
+        ring->last_change = g_get_real_time();
+    }
+    ring->state = new_state;
+    ring->carrier = new_carrier;
+    snprintf(ring->addr, sizeof(ring->addr), "%s", ring_links[iface_no].addr);
+    shm_state->ring_count = MIN(ring_total, IFCHECKD_SHM_MAX_RINGS);
+    ifcheckd_shm_write_end(shm_state);
+}
+
+/**
+ * Clear the rings of the state file while not monitoring
+ */
+static void
+_shm_clear(void)
+{
+    if (shm_state == NULL) {
+        return;
+    }
+    ifcheckd_shm_write_begin(shm_state);
+    memset(shm_state->rings, 0, sizeof(shm_state->rings));
+    shm_state->ring_count = 0;
+    ifcheckd_shm_write_end(shm_state);
+}
+
+/**
+ * Unmap and remove the state file
+ */
+static void
+_shm_finalize(void)
+{
+    if (shm_state == NULL) {
+        return;
+    }
+    munmap(shm_state, sizeof(struct ifcheckd_shm));
+    shm_state = NULL;
+    unlink(IFCHECKD_SHM_FILE);
+}
+
+/**
+ * Set the number of rings, and publish it to the state file
+ * @param total the number of rings
+ */
+static void
+_set_ring_total(unsigned int total)
+{
+    ring_total = total;
+    if (shm_state == NULL) {
+        return;
+    }
+    ifcheckd_shm_write_begin(shm_state);
+    shm_state->ring_count = MIN(ring_total, IFCHECKD_SHM_MAX_RINGS);
+    ifcheckd_shm_write_end(shm_state);
+}
+
+/**
+ * Keep whether a ring is UP.
+ * The number of rings is not changed here: the resync sets it when all
+ * rings are done, and a ring event raises it by _send_attr_iface.
+ * @param iface_no the ring number
+ * @param state the string of ring link status
+ * @return if the ring number is within MAX_RINGS, TRUE. otherwise, FALSE
+ */
+static gboolean
+_set_ring_health(uint32_t iface_no,
+        const char *state)
+{
+    if (iface_no >= MAX_RINGS) {
+        crm_err("Too large ring number [ring id=%u, max=%u]", iface_no, MAX_RINGS);
+        return FALSE;
+    }
+    ring_healthy[iface_no] = strcmp(state, STATE_UP) == 0;
+    _shm_update_ring(iface_no, state);
+    return TRUE;
+}
+
+/**
+ * Update or delete the numeric ring state attribute by ring number
+ * @param iface_no the ring number
+ * @param delete TRUE to delete the attribute
+ * @param size the length of attribute name and attribute value
+ * @return if a attribute can be updated, TRUE. otherwise, FALSE
+ */
+static gboolean
+_update_attr_ringstate(uint32_t iface_no,
+        gboolean delete,
+        size_t size)
+{
+    char if_attr[size];
+    char if_value[size];
+    int len = -1;
+
+    len = snprintf(if_attr, size, ATTR_RINGSTATE_NAME_FORMAT, iface_no);
+    if (!(-1 < len && len < size)) {
+        crm_debug("Failed to copy ring number: len=%d", len);
+        return FALSE;
+    }
+    len = snprintf(if_value, size, ATTR_NUMBER_FORMAT,
+            iface_no < MAX_RINGS && ring_healthy[iface_no] ? 1 : 0);
+    if (!(-1 < len && len < size)) {
+        crm_debug("Failed to copy ring state: len=%d", len);
+        return FALSE;
+    }
+    return _update_attr_value(if_attr, delete ? NULL : if_value);
+}
+
+/**
+ * Update or delete the numbers of UP rings and all rings
+ * @param delete TRUE to delete the attributes
+ * @param size the length of attribute value
+ * @return if all attributes can be updated, TRUE. otherwise, FALSE
+ */
+static gboolean
+_update_attr_ring_count(gboolean delete,
+        size_t size)
+{
+    char healthy_value[size];
+    char total_value[size];
+    unsigned int healthy = 0;
+    unsigned int i;
+    int len = -1;
+
+    for (i = 0; i < ring_total; i++) {
+        if (ring_healthy[i]) {
+            healthy++;
+        }
+    }
+    len = snprintf(healthy_value, size, ATTR_NUMBER_FORMAT, healthy);
+    if (!(-1 < len && len < size)) {
+        crm_debug("Failed to copy the number of UP rings: len=%d", len);
+        return FALSE;
+    }
+    len = snprintf(total_value, size, ATTR_NUMBER_FORMAT, ring_total);
+    if (!(-1 < len && len < size)) {
+        crm_debug("Failed to copy the number of rings: len=%d", len);
+        return FALSE;
+    }
+    if (_update_attr_value(ATTR_HEALTHY_COUNT_NAME,
+                    delete ? NULL : healthy_value) == FALSE) {
+        return FALSE;
+    }
+    return _update_attr_value(ATTR_TOTAL_COUNT_NAME,
+            delete ? NULL : total_value);
+}
+
+/**
+ * Update or delete the carrier attribute by ring number
+ * @param iface_no the ring number
+ * @param delete TRUE to delete the attribute
+ * @param size the length of attribute name
+ * @return if a attribute can be updated, TRUE. otherwise, FALSE
+ */
+static gboolean
+_update_attr_carrier(uint32_t iface_no,
+        gboolean delete,
+        size_t size)
+{
+    char if_attr[size];
+    int len = -1;
+
+    if (delete == FALSE && iface_no >= MAX_RINGS) {
+        return FALSE;
+    }
+    len = snprintf(if_attr, size, ATTR_CARRIER_NAME_FORMAT, iface_no);
+    if (!(-1 < len && len < size)) {
+        crm_debug("Failed to copy ring number: len=%d", len);
+        return FALSE;
+    }
+    return _update_attr_value(if_attr, delete ? NULL :
+            ring_links[iface_no].carrier ? CARRIER_UP : CARRIER_LOST);
+}
+
+/**
+ * Publish the carrier state of a ring when it changed.
+ * This is an early notice only, FAULTY and UP are decided by corosync.
+ * @param iface_no the ring number
+ * @param carrier TRUE if the carrier is up
+ */
+static void
+_rtnl_carrier_event(uint32_t iface_no,
+        gboolean carrier)
+{
+    struct ring_link *link = &ring_links[iface_no];
+
+    if (link->known && link->carrier == carrier) {
+        return;
+    }
+    link->carrier = carrier;
+    if (_update_attr_carrier(iface_no, FALSE, MAX_LENGTH) == FALSE) {
+        crm_err("Failed to change carrier status [ring id=%u, expected state=%s]",
+                iface_no, carrier ? CARRIER_UP : CARRIER_LOST);
+        link->known = FALSE;
+        _shm_update_ring(iface_no, NULL);
+        return;
+    }
+    if (carrier == FALSE) {
+        crm_warn("Interface carrier lost [ring id=%u, ifindex=%u]",
+                iface_no, link->ifindex);
+    } else if (link->known) {
+        crm_info("Interface carrier recovered [ring id=%u, ifindex=%u]",
+                iface_no, link->ifindex);
+    }
+    link->known = TRUE;
+    _shm_update_ring(iface_no, NULL);
+}
+
+/**
+ * Map each ring address to its kernel interface, and publish the carrier
+ * of the interface. A ring whose address is on no interface has lost it.
+ */
+static void
+_rtnl_ring_lookup(void)
+{
+    struct ifaddrs *ifaddr, *ifa;
+    union {
+        struct in_addr v4;
+        struct in6_addr v6;
+    } addr;
+    char ifname[IF_NAMESIZE];
+    unsigned int i;
+    int family;
+    gboolean carrier;
+
+    if (getifaddrs(&ifaddr) != 0) {
+        crm_perror(LOG_ERR, "Could not get interface addresses");
+        return;
+    }
+
+    for (i = 0; i < ring_total && i < MAX_RINGS; i++) {
+        if (inet_pton(AF_INET, ring_links[i].addr, &addr) == 1) {
+            family = AF_INET;
+        } else if (inet_pton(AF_INET6, ring_links[i].addr, &addr) == 1) {
+            family = AF_INET6;
+        } else {
+            crm_debug("ring id=%u has no address to watch: %s",
+                    i, ring_links[i].addr);
+            continue;
+        }
+
+        ring_links[i].ifindex = 0;
+        carrier = FALSE;
+        for (ifa = ifaddr; ifa != NULL; ifa = ifa->ifa_next) {
+            if (ifa->ifa_addr == NULL || ifa->ifa_addr->sa_family != family) {
+                continue;
+            }
+            if (family == AF_INET
+                    ? memcmp(&((struct sockaddr_in *) ifa->ifa_addr)->sin_addr,
+                            &addr.v4, sizeof(addr.v4)) != 0
+                    : memcmp(&((struct sockaddr_in6 *) ifa->ifa_addr)->sin6_addr,
+                            &addr.v6, sizeof(addr.v6)) != 0) {
+                continue;
+            }
+            /* an alias label "eth0:1" is on the interface "eth0" */
+            snprintf(ifname, sizeof(ifname), "%s", ifa->ifa_name);
+            ifname[strcspn(ifname, ":")] = '\0';
+            ring_links[i].ifindex = if_nametoindex(ifname);
+            carrier = (ifa->ifa_flags & IFF_RUNNING) != 0;
+            crm_debug("ring id=%u is on %s [ifindex=%u, carrier=%d]",
+                    i, ifname, ring_links[i].ifindex, carrier);
+            break;
+        }
+        _rtnl_carrier_event(i, carrier);
+    }
+    freeifaddrs(ifaddr);
+}
+
+/**
+ * rtnetlink dispatch function.
+ * A link message updates the carrier of the rings on the interface.
+ * An address message maps the rings to the interfaces again.
+ * @param user_data the gpointer of user data
+ * @return always 0
+ */
+static int
+_rtnl_dispatch(gpointer user_data)
+{
+    char buf[RTNL_RECV_LEN];
+    struct nlmsghdr *nh;
+    struct ifinfomsg *ifi;
+    gboolean relookup = FALSE;
+    unsigned int i;
+    ssize_t len;
+
+    while ((len = recv(rtnl_fd, buf, sizeof(buf), 0)) != 0) {
+        if (len < 0) {
+            /* messages are lost, so read the current state */
+            if (errno == ENOBUFS) {
+                relookup = TRUE;
+                continue;
+            }
+            break;
+        }
+        for (nh = (struct nlmsghdr *) buf; NLMSG_OK(nh, len);
+                nh = NLMSG_NEXT(nh, len)) {
+            switch (nh->nlmsg_type) {
+            case RTM_NEWLINK:
+            case RTM_DELLINK:
+                ifi = NLMSG_DATA(nh);
+                for (i = 0; i < ring_total && i < MAX_RINGS; i++) {
+                    if (ring_links[i].ifindex != 0
+                            && ring_links[i].ifindex == ifi->ifi_index) {
+                        _rtnl_carrier_event(i, nh->nlmsg_type == RTM_NEWLINK
+                                && (ifi->ifi_flags & IFF_RUNNING) != 0);
+                    }
+                }
+                break;
+            case RTM_NEWADDR:
+            case RTM_DELADDR:
+                relookup = TRUE;
+                break;
+            default:
+                break;
+            }
+        }
+    }
+
+    if (relookup) {
+        _rtnl_ring_lookup();
+    }
+    return 0;
+}
+
+/**
+ * rtnetlink destroy function
+ * @param user_data the gpointer of user data
+ */
+static void
+_rtnl_destroy(gpointer user_data)
+{
+    crm_debug("rtnetlink watch is destroyed");
+    rtnl_source = NULL;
+}
+
+/**
+ * Add the rtnetlink socket watching links and addresses to mainloop
+ * @return if the socket can be added mainloop, TRUE. otherwise FALSE.
+ */
+static gboolean
+_rtnl_init(void)
+{
+    struct sockaddr_nl snl;
+
+    static struct mainloop_fd_callbacks rtnl_fd_callbacks = {
+            .dispatch = _rtnl_dispatch,
+            .destroy = _rtnl_destroy,
+    };
+
+    rtnl_fd = socket(AF_NETLINK, SOCK_RAW | SOCK_NONBLOCK | SOCK_CLOEXEC,
+            NETLINK_ROUTE);
+    if (rtnl_fd < 0) {
+        crm_perror(LOG_ERR, "Could not open a rtnetlink socket");
+        return FALSE;
+    }
+
+    memset(&snl, 0, sizeof(snl));
+    snl.nl_family = AF_NETLINK;
+    snl.nl_groups = RTNL_GROUPS;
+    if (bind(rtnl_fd, (struct sockaddr *) &snl, sizeof(snl)) != 0) {
+        crm_perror(LOG_ERR, "Could not bind a rtnetlink socket");
+        goto bail;
+    }
+
+    rtnl_source = mainloop_add_fd("rtnetlink",
+            RING_EVENT_PRIORITY,
+            rtnl_fd,
+            NULL,
+            &rtnl_fd_callbacks);
+    if (rtnl_source == NULL) {
+        crm_debug("Failed to add rtnetlink fd to mainloop");
+        goto bail;
+    }
+    return TRUE;
+
+    bail:
+    close(rtnl_fd);
+    rtnl_fd = -1;
+    return FALSE;
+}
+
+/**
+ * Remove the rtnetlink socket from mainloop
  */
-static gboolean
-_update_attr_iface(uint32_t iface_no,
-        const char *interface_name,
-        const char *state,
-        size_t size)
+static void
+_rtnl_finalize(void)
 {
-    char if_attr[size];
-    char if_value[size];
-    const char *attr_section = NULL;
-    const char *attr_set = NULL;
-    int len = -1;
+    unsigned int i;
 
-    len = snprintf(if_attr, size, ATTR_NAME_FORMAT, iface_no);
-    if (!(-1 < len && len < size)) {
-        crm_debug("Failed to copy ring number: len=%d", len);
-        return FALSE;
+    if (rtnl_source != NULL) {
+        mainloop_del_fd(rtnl_source);
     }
-    len = snprintf(if_value, size, ATTR_VALUE_FORMAT, interface_name, state);
-    if (!(-1 < len && len < size)) {
-        crm_debug("Failed to copy interface name: len=%d", len);
-        return FALSE;
+    if (rtnl_fd >= 0) {
+        close(rtnl_fd);
+        rtnl_fd = -1;
     }
-    if (attrd_update_delegate(NULL, 'U', NULL, if_attr, if_value,
-                    attr_section, attr_set, NULL, NULL, attr_options) != pcmk_ok) {
-        crm_debug("Could not update %s=%s", if_attr, if_value);
-        return FALSE;
+    for (i = 0; i < MAX_RINGS; i++) {
+        ring_links[i].ifindex = 0;
+        ring_links[i].known = FALSE;
     }
-    return TRUE;
 }
 
 /**
@@ -493,162 +1044,318 @@ _corosync_cfg_ring_status_free(unsigned int interface_count,
 }
 
 /**
- * Delete all attributes relating to ring number
- * @return if all attributes can be delete, TRUE. otherwise, FALSE
+ * Release the ring status of the attribute work, and its connections
+ */
+static void
+_attr_work_end(void)
+{
+    if (attr_work.source_id != 0) {
+        g_source_remove(attr_work.source_id);
+        attr_work.source_id = 0;
+    }
+    if (attr_work.interface_names != NULL) {
+        _corosync_cfg_ring_status_free(attr_work.interface_count,
+                attr_work.interface_names,
+                attr_work.interface_status);
+        attr_work.interface_names = NULL;
+        attr_work.interface_status = NULL;
+    }
+    attr_work.interface_count = 0;
+    if (attr_work.cfg_handle != 0) {
+        (void) corosync_cfg_finalize(attr_work.cfg_handle);
+        attr_work.cfg_handle = 0;
+    }
+    if (attr_work.cmap_handle != 0) {
+        (void) cmap_finalize(attr_work.cmap_handle);
+        attr_work.cmap_handle = 0;
+    }
+}
+
+/**
+ * Get the ring status to update or delete all attributes relating to
+ * ring number. Any running attribute work is cancelled.
+ * @param delete TRUE to delete the attributes, FALSE to update them
+ * @return if the ring status can be gotten, TRUE. otherwise, FALSE
  */
 static gboolean
-_attr_iface_finalize(void)
+_attr_work_begin(gboolean delete)
 {
-    size_t size = MAX_LENGTH;
     cs_error_t result;
-    corosync_cfg_handle_t handle;
-    unsigned int interface_count;
-    char **interface_names;
-    char **interface_status;
-    unsigned int i;
-
-    gboolean rc = FALSE;
 
-    crm_debug("Start to finalize attribute information.");
+    _attr_work_end();
+    crm_debug("Start to %s attribute information.",
+            delete ? "finalize" : "initialize");
 
     if (_is_alive_pacemakerd() == FALSE) {
         crm_debug("Cannot confirm start of pacemakerd.");
         return FALSE;
     }
 
-    result = corosync_cfg_initialize(&handle, NULL);
+    result = corosync_cfg_initialize(&attr_work.cfg_handle, NULL);
     if (result != CS_OK) {
         crm_debug("Could not initialize corosync configuration API error %d",
                 result);
+        attr_work.cfg_handle = 0;
         return FALSE;
     }
 
-    result = corosync_cfg_ring_status_get(handle, &interface_names,
-            &interface_status, &interface_count);
+    if (delete == FALSE) {
+        result = cmap_initialize(&attr_work.cmap_handle);
+        if (result != CS_OK) {
+            crm_debug("Failed to initialize the cmap API. Error %d", result);
+            attr_work.cmap_handle = 0;
+            goto bail;
+        }
+    }
+
+    result = corosync_cfg_ring_status_get(attr_work.cfg_handle,
+            &attr_work.interface_names, &attr_work.interface_status,
+            &attr_work.interface_count);
     if (result != CS_OK) {
         crm_debug("Could not get the ring status, the error is %d", result);
-        rc = FALSE;
-    } else {
-        for (i = 0; i < interface_count; i++) {
-            crm_debug("ring id=%d, ifname= %s, status= %s",
-                    i, interface_names[i], interface_status[i]);
-
-            if (_delete_attr_iface(i, size) == FALSE) {
-                crm_debug("Failed to delete attribute");
-                rc = FALSE;
-                goto out_free;
-            }
-        }
-        rc = TRUE;
+        attr_work.interface_names = NULL;
+        attr_work.interface_status = NULL;
+        attr_work.interface_count = 0;
+        goto bail;
     }
 
-    out_free:
-        _corosync_cfg_ring_status_free(interface_count,
-                interface_names,
-                interface_status);
-        (void) corosync_cfg_finalize(handle);
-        return rc;
+    attr_work.delete = delete;
+    attr_work.next = 0;
+    attr_work.total = 0;
+    attr_work.busy = 0;
+    return TRUE;
+
+    bail:
+    _attr_work_end();
+    return FALSE;
 }
 
 /**
- * Update all attributes relating to ring number
- * @return if all attributes can be updated, TRUE. otherwise, FALSE
+ * Delete the attributes of a ring
+ * @param i the ring number
+ * @return if all attributes can be deleted, TRUE. otherwise, FALSE
  */
 static gboolean
-_attr_iface_init(void)
+_attr_work_delete_ring(unsigned int i)
+{
+    size_t size = MAX_LENGTH;
+
+    crm_debug("ring id=%d, ifname= %s, status= %s",
+            i, attr_work.interface_names[i], attr_work.interface_status[i]);
+
+    if (_delete_attr_iface(i, size) == FALSE
+            || _update_attr_ringstate(i, TRUE, size) == FALSE
+            || _update_attr_carrier(i, TRUE, size) == FALSE) {
+        crm_debug("Failed to delete attribute");
+        return FALSE;
+    }
+    return TRUE;
+}
+
+/**
+ * Update the attributes of a ring by its faulty key.
+ * It does not wait for a busy cmap, the ring is retried on a later step.
+ * @param i the ring number
+ * @return if all attributes are updated, 1. if cmap is busy, 0. on error, -1
+ */
+static int
+_attr_work_update_ring(unsigned int i)
 {
     size_t size = MAX_LENGTH;
     cs_error_t result;
-    corosync_cfg_handle_t handle;
-    cmap_handle_t handle2;
     uint8_t faulty;
     char tmp_key[CMAP_KEYNAME_MAXLEN];
-    int no_retries;
-    unsigned int interface_count;
-    char **interface_names;
-    char **interface_status;
     char state[size];
-    unsigned int i;
     int len;
-    gboolean rc = FALSE;
 
-    crm_debug("Start to initialize attribute information.");
-
-    if (_is_alive_pacemakerd() == FALSE) {
-        crm_debug("Cannot confirm start of pacemakerd.");
-        return FALSE;
+    crm_debug("ring id=%d, ifname= %s, status= %s",
+            i, attr_work.interface_names[i], attr_work.interface_status[i]);
+    len = snprintf(tmp_key, CMAP_KEYNAME_MAXLEN, FAULTY_KEY_MAKE_FORMAT, i);
+    if (!(-1 < len && len < size)) {
+        crm_debug("Failed to copy string: len=%d", len);
+        return -1;
     }
 
-    result = corosync_cfg_initialize(&handle, NULL);
-    if (result != CS_OK) {
-        crm_debug("Could not initialize corosync configuration API error %d",
-                result);
-        return FALSE;
+    result = cmap_get_uint8(attr_work.cmap_handle, tmp_key, &faulty);
+    if (result == CS_ERR_TRY_AGAIN) {
+        crm_debug("cmap is busy, retry ring id=%u later", i);
+        return 0;
     }
-
-    result = cmap_initialize(&handle2);
     if (result != CS_OK) {
-        crm_debug("Failed to initialize the cmap API. Error %d", result);
-        (void) corosync_cfg_finalize(handle);
-        return FALSE;
+        crm_debug("Failed to connect cmap.  Error %d", result);
+        return -1;
     }
 
-    result = corosync_cfg_ring_status_get(handle, &interface_names,
-            &interface_status, &interface_count);
-    if (result != CS_OK) {
-        crm_debug("Could not get the ring status, the error is %d", result);
-        rc = FALSE;
+    if (faulty == 0){
+        len = snprintf(state, size, STATE_UP);
+    } else if (faulty == 1){
+        len = snprintf(state, size, STATE_FAULTY);
     } else {
-        for (i = 0; i < interface_count; i++) {
-            crm_debug("ring id=%d, ifname= %s, status= %s",
-                    i, interface_names[i], interface_status[i]);
-            len = snprintf(tmp_key, CMAP_KEYNAME_MAXLEN, FAULTY_KEY_MAKE_FORMAT, i);
-            if (!(-1 < len && len < size)) {
-                crm_debug("Failed to copy string: len=%d", len);
-                rc = FALSE;
-                goto out_free;
-            }
+        len = snprintf(state, size, STATE_UNKOWN);
+    }
+    if (!(-1 < len && len < size)) {
+        crm_debug("Failed to copy string: len=%d", len);
+        return -1;
+    }
+    if (i < MAX_RINGS) {
+        snprintf(ring_links[i].addr, sizeof(ring_links[i].addr),
+                "%s", attr_work.interface_names[i]);
+    }
+    if (_update_attr_iface(i, attr_work.interface_names[i], state, size) == FALSE
+            || _set_ring_health(i, state) == FALSE
+            || _update_attr_ringstate(i, FALSE, size) == FALSE) {
+        crm_debug("Failed to send value to attrd");
+        return -1;
+    }
+    attr_work.total = i + 1;
+    return 1;
+}
 
-            no_retries = 0;
-            while ((result = cmap_get_uint8(handle2, tmp_key, &faulty))
-                    == CS_ERR_TRY_AGAIN && no_retries++ < CMAP_MAX_RETRIES) {
-                sleep(1);
-            }
+/**
+ * Work on the attributes of the next rings.
+ * @param budget microseconds to work, or 0 to work until the end
+ * @return if all rings are done, 1. if rings are left, 0. on error, -1
+ */
+static int
+_attr_work_rings(gint64 budget)
+{
+    size_t size = MAX_LENGTH;
+    gint64 start = g_get_monotonic_time();
+    int rc;
 
-            if (result != CS_OK) {
-                crm_debug("Failed to connect cmap.  Error %d", result);
-                rc = FALSE;
-                goto out_free;
+    while (attr_work.next < attr_work.interface_count) {
+        if (budget > 0 && g_get_monotonic_time() - start >= budget) {
+            return 0;
+        }
+        if (attr_work.delete) {
+            rc = _attr_work_delete_ring(attr_work.next) ? 1 : -1;
+        } else {
+            rc = _attr_work_update_ring(attr_work.next);
+        }
+        if (rc == 0) {
+            /* cmap is busy, so the ring is retried on a later step */
+            if (++attr_work.busy > CMAP_MAX_RETRIES) {
+                crm_debug("cmap is still busy [retries=%u]", attr_work.busy);
+                return -1;
             }
+            return 0;
+        }
+        if (rc < 0) {
+            return -1;
+        }
+        attr_work.busy = 0;
+        attr_work.next++;
+    }
 
-            if (faulty == 0){
-                len = snprintf(state, size, STATE_UP);
-            } else if (faulty == 1){
-                len = snprintf(state, size, STATE_FAULTY);
-            } else {
-                len = snprintf(state, size, STATE_UNKOWN);
-            }
-            if (!(-1 < len && len < size)) {
-                crm_debug("Failed to copy string: len=%d", len);
-                rc = FALSE;
-                goto out_free;
-            }
-            if (_update_attr_iface(i, interface_names[i], state, size) == FALSE) {
-                crm_debug("Failed to send value to attrd");
-                rc = FALSE;
-                goto out_free;
-            }
+    /*
+     * ring_total keeps the previous count until all rings are done, so that
+     * a ring event during the work does not send a partial count.
+     */
+    if (attr_work.delete == FALSE) {
+        _set_ring_total(attr_work.total);
+    }
+
+    /* the numbers are sent once after all rings */
+    if (_update_attr_ring_count(attr_work.delete, size) == FALSE) {
+        crm_debug("Failed to %s the number of rings",
+                attr_work.delete ? "delete" : "send");
+        return -1;
+    }
+    if (attr_work.delete) {
+        _set_ring_total(0);
+    }
+    return 1;
+}
+
+/**
+ * Add the source of the next step of the attribute work.
+ * The step runs when idle, or after BACKGROUND_BUSY_INTERVAL_MSEC while
+ * cmap is busy.
+ */
+static void
+_attr_work_schedule(void)
+{
+    if (attr_work.busy > 0) {
+        attr_work.source_id = g_timeout_add_full(BACKGROUND_PRIORITY,
+                BACKGROUND_BUSY_INTERVAL_MSEC, _attr_work_step, NULL, NULL);
+    } else {
+        attr_work.source_id = g_idle_add_full(BACKGROUND_PRIORITY,
+                _attr_work_step, NULL, NULL);
+    }
+}
+
+/**
+ * Idle function for the attribute work.
+ * It works for BACKGROUND_STEP_BUDGET_MSEC at most, and yields to the
+ * ring events, which have the higher priority.
+ * @param user_data the gpointer of user data
+ * @return if rings are left on the same source, TRUE. otherwise, FALSE.
+ */
+static gboolean
+_attr_work_step(gpointer user_data)
+{
+    gboolean delete = attr_work.delete;
+    gboolean was_busy = attr_work.busy > 0;
+    int rc;
+
+    step_start = g_get_monotonic_time();
+    rc = _attr_work_rings(BACKGROUND_STEP_BUDGET_MSEC * 1000LL);
+    step_end = g_get_monotonic_time();
+    if ((step_end - step_start) / 1000 > BACKGROUND_STEP_BUDGET_MSEC) {
+        crm_debug("Attribute work exceeded the budget [%lldms]",
+                (long long) (step_end - step_start) / 1000);
+    }
+    if (rc == 0) {
+        if (was_busy == (attr_work.busy > 0)) {
+            return TRUE;
         }
-        rc = TRUE;
+        /* switch between the idle source and the busy interval */
+        _attr_work_schedule();
+        return FALSE;
     }
 
-    out_free:
-        _corosync_cfg_ring_status_free(interface_count,
-                interface_names,
-                interface_status);
-        (void) corosync_cfg_finalize(handle);
-        (void) cmap_finalize(handle2);
-        return rc;
+    /* the source is removed by returning FALSE */
+    attr_work.source_id = 0;
+    _attr_work_end();
+    if (delete == FALSE) {
+        _attr_resync_done(rc > 0);
+    } else if (rc < 0) {
+        crm_debug("Failed to finalize attribute information.");
+    }
+    return FALSE;
+}
+
+/**
+ * Start to update or delete all attributes relating to ring number
+ * in the background
+ * @param delete TRUE to delete the attributes, FALSE to update them
+ * @return if the work can be started, TRUE. otherwise, FALSE
+ */
+static gboolean
+_attr_work_start(gboolean delete)
+{
+    if (_attr_work_begin(delete) == FALSE) {
+        return FALSE;
+    }
+    _attr_work_schedule();
+    return TRUE;
+}
+
+/**
+ * Delete all attributes relating to ring number at once
+ * @return if all attributes can be delete, TRUE. otherwise, FALSE
+ */
+static gboolean
+_attr_iface_finalize(void)
+{
+    int rc;
+
+    if (_attr_work_begin(TRUE) == FALSE) {
+        return FALSE;
+    }
+    rc = _attr_work_rings(0);
+    _attr_work_end();
+    return rc > 0;
 }
 
 /**
@@ -725,7 +1432,13 @@ _send_attr_iface(uint32_t iface_no,
     char interface_name[size];
     gboolean rc = FALSE;
 
-    rc = _get_interface_name(iface_no, interface_name, size);
+    /* the address is kept by the resync, so ask corosync only without it */
+    if (iface_no < MAX_RINGS && ring_links[iface_no].addr[0] != '\0') {
+        snprintf(interface_name, size, "%s", ring_links[iface_no].addr);
+        rc = TRUE;
+    } else {
+        rc = _get_interface_name(iface_no, interface_name, size);
+    }
     if (rc == FALSE) {
         crm_debug("Failed to convert a ring id into a interface name");
         return rc;
@@ -735,6 +1448,17 @@ _send_attr_iface(uint32_t iface_no,
         crm_debug("Failed to send to attrd");
         return rc;
     }
+    /* during the resync, the ring is counted when all rings are done */
+    if (iface_no < MAX_RINGS && iface_no >= ring_total && attr_work.source_id == 0) {
+        _set_ring_total(iface_no + 1);
+    }
+    rc = _set_ring_health(iface_no, state)
+            && _update_attr_ringstate(iface_no, FALSE, size)
+            && _update_attr_ring_count(FALSE, size);
+    if (rc == FALSE) {
+        crm_debug("Failed to send the numeric ring state to attrd");
+        return rc;
+    }
     return TRUE;
 }
 
@@ -747,6 +1471,8 @@ static void
 _cs_rrp_faulty_event(uint32_t iface_no,
         const char *state)
 {
+    long long latency;
+
     if (_send_attr_iface(iface_no, state, MAX_LENGTH) == FALSE) {
         crm_err("Failed to change link status [ring id=%u, expected state=%s]",
                 iface_no, state);
@@ -754,6 +1480,15 @@ _cs_rrp_faulty_event(uint32_t iface_no,
     }
     crm_info("Interface link status changed [ring id=%u, state=%s]",
             iface_no, state);
+
+    latency = (g_get_monotonic_time() - publish_since) / 1000;
+    if (latency > PUBLISH_LATENCY_BOUND_MSEC) {
+        crm_warn("Interface link status published late [ring id=%u, latency=%lldms, bound=%dms]",
+                iface_no, latency, PUBLISH_LATENCY_BOUND_MSEC);
+    } else {
+        crm_debug("Interface link status published [ring id=%u, latency=%lldms]",
+                iface_no, latency);
+    }
 }
 
 /**
@@ -908,7 +1643,7 @@ _cs_cmap_init(void)
     }
 
     cmap_source = mainloop_add_fd("corosync-cmap",
-            G_PRIORITY_DEFAULT,
+            RING_EVENT_PRIORITY,
             cmap_fd,
             &cmap_handle,
             &cmap_fd_callbacks);
@@ -953,50 +1688,94 @@ _cs_cmap_init(void)
 }
 
 /**
- * Timeout function for initializing attributes
- * @return if initialization succeeded, TRUE. otherwise, FALSE.
+ * Finish the initialization after the attributes were updated.
+ * The timer is stopped when ifcheckd monitors cmap.
+ * @param synced TRUE if all attributes were updated
  */
-static gboolean
-_regular_attr_init(gpointer interval)
+static void
+_attr_resync_done(gboolean synced)
 {
-    crm_debug("Start to initialize ifcheckd");
+    if (synced == FALSE) {
+        crm_debug("Failed to initialize attribute information, retry it");
+        return;
+    }
 
-    if (_attr_iface_init() == FALSE) {
-        return TRUE;
+    /* the carrier is an early notice, so ifcheckd works without it */
+    if (rtnl_source == NULL && _rtnl_init() == FALSE) {
+        crm_warn("Could not watch the interface carrier");
+    }
+    if (rtnl_source != NULL) {
+        _rtnl_ring_lookup();
     }
 
     /* timer stop when we already have cmap_handle */
     if (cmap_handle != 0) {
         crm_debug("Finished to initialize ifcheckd. cmap_handle existed");
         crm_notice("Start to monitor interface after Pacemaker restarted");
-        w_timer.timer_id = 0;
-        return FALSE;
-    }
-
-    /* timer stop after we got cmap_handler */
-    if (_cs_cmap_init() == TRUE) {
+    } else if (_cs_cmap_init() == TRUE) {
+        /* timer stop after we got cmap_handler */
         crm_debug("Finished to initialize ifcheckd. cmap_handle created");
         crm_notice("Start to monitor interface");
+    } else {
+        return;
+    }
+    if (w_timer.timer_id != 0) {
+        g_source_remove(w_timer.timer_id);
         w_timer.timer_id = 0;
-        return FALSE;
+    }
+}
+
+/**
+ * Timeout function for initializing attributes.
+ * The attributes are updated in the background, and the initialization
+ * finishes in _attr_resync_done.
+ * @return always TRUE, the timer is stopped by _attr_resync_done
+ */
+static gboolean
+_regular_attr_init(gpointer interval)
+{
+    crm_debug("Start to initialize ifcheckd");
+
+    /* wait for the running resync or cleanup */
+    if (attr_work.source_id != 0) {
+        crm_debug("Attribute work is running [%s]",
+                attr_work.delete ? "finalize" : "initialize");
+        return TRUE;
     }
 
+    (void) _attr_work_start(FALSE);
     return TRUE;
 }
 
 /**
- * Finalize deamon.
+ * Stop monitoring, and delete all attributes relating to ring number
+ * @param background TRUE to delete the attributes in the background
  */
-void
-ifcheckd_finalize(void)
+static void
+_ifcheckd_stop(gboolean background)
 {
-    (void)_attr_iface_finalize();
+    if (background == FALSE) {
+        (void)_attr_iface_finalize();
+    } else if (_attr_work_start(TRUE) == FALSE) {
+        crm_debug("Could not start to finalize attribute information.");
+    }
+    _rtnl_finalize();
+    _shm_clear();
     (void)cmap_track_delete(cmap_handle, track_handle_rrp_faulty_key_changed);
     (void)cmap_track_delete(cmap_handle, track_handle_connections_key_changed);
     (void)cmap_finalize(cmap_handle);
     cmap_handle = 0;
 }
 
+/**
+ * Finalize deamon.
+ */
+void
+ifcheckd_finalize(void)
+{
+    _ifcheckd_stop(FALSE);
+}
+
 /**
  * Add initialize function to mainloop.
  */
@@ -1008,9 +1787,11 @@ ifcheckd_init(void)
         crm_debug("The timer already existed");
         return;
     }
-    w_timer.timer_id = g_timeout_add_seconds(w_timer.seconds,
+    w_timer.timer_id = g_timeout_add_seconds_full(BACKGROUND_PRIORITY,
+            w_timer.seconds,
             _regular_attr_init,
-            &w_timer);
+            &w_timer,
+            NULL);
 }
 
 /**
@@ -1095,10 +1876,12 @@ main(int argc, char **argv)
     mainloop_add_signal(SIGTERM, _ifcheckd_shutdown);
     mainloop_add_signal(SIGINT, _ifcheckd_shutdown);
 
+    _shm_init();
     ifcheckd_init();
     g_main_loop_run(mainloop);
 
     ifcheckd_finalize();
+    _shm_finalize();
     unlink(pid_file);
     free(pid_file);
     crm_notice("Exiting %s", crm_system_name);
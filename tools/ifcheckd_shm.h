@@ -0,0 +1,175 @@
+/*
+ * ifcheckd_shm.h - Ring state exported by ifcheckd in a memory-mapped file
+ *
+ * Copyright (C) 2026 NIPPON TELEGRAPH AND TELEPHONE CORPORATION
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef IFCHECKD_SHM_H
+#define IFCHECKD_SHM_H
+
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <sys/types.h>
+
+/**
+ * state file path
+ * (ifcheckd creates it and removes it on exit)
+ */
+#define IFCHECKD_SHM_FILE "/var/run/ifcheckd.state"
+
+/**
+ * magic number of the state file ("IFCD")
+ */
+#define IFCHECKD_SHM_MAGIC 0x44434649
+
+/**
+ * layout version of the state file
+ * (incremented when the layout changes incompatibly)
+ */
+#define IFCHECKD_SHM_VERSION 2
+
+/**
+ * max number of rings in the state file
+ */
+#define IFCHECKD_SHM_MAX_RINGS 8
+
+/**
+ * length of a ring address
+ * (same as INET6_ADDRSTRLEN, rounded up)
+ */
+#define IFCHECKD_SHM_ADDR_LEN 48
+
+/**
+ * times to retry a read which overlapped a write
+ */
+#define IFCHECKD_SHM_READ_RETRIES 100
+
+/**
+ * ring state decided by corosync
+ */
+enum ifcheckd_shm_state {
+    IFCHECKD_SHM_STATE_UNKNOWN = 0,
+    IFCHECKD_SHM_STATE_UP = 1,
+    IFCHECKD_SHM_STATE_FAULTY = 2
+};
+
+/**
+ * carrier state reported by the kernel
+ */
+enum ifcheckd_shm_carrier {
+    IFCHECKD_SHM_CARRIER_UNKNOWN = 0,
+    IFCHECKD_SHM_CARRIER_UP = 1,
+    IFCHECKD_SHM_CARRIER_LOST = 2
+};
+
+/**
+ * ring entry of the state file
+ */
+struct ifcheckd_shm_ring {
+    uint32_t state; /**< enum ifcheckd_shm_state */
+    uint32_t carrier; /**< enum ifcheckd_shm_carrier */
+    int64_t last_change; /**< the last change of state or carrier(epoch, microseconds) */
+    char addr[IFCHECKD_SHM_ADDR_LEN]; /**< ring bind address */
+};
+
+/**
+ * state file layout.
+ * generation is odd while ifcheckd is writing. A reader copies the file
+ * and retries if generation was odd or changed during the copy.
+ * pid tells a reader whether the file was left by a killed ifcheckd.
+ */
+struct ifcheckd_shm {
+    uint32_t magic; /**< IFCHECKD_SHM_MAGIC */
+    uint32_t version; /**< IFCHECKD_SHM_VERSION */
+    uint32_t generation; /**< seqlock generation */
+    uint32_t ring_count; /**< the number of valid rings, 0 while not monitoring */
+    int32_t pid; /**< pid of ifcheckd which writes the file */
+    uint32_t reserved; /**< padding, always 0 */
+    struct ifcheckd_shm_ring rings[IFCHECKD_SHM_MAX_RINGS]; /**< ring entries */
+};
+
+/**
+ * Start to write the state file
+ * @param shm the mapped state file
+ */
+static inline void
+ifcheckd_shm_write_begin(struct ifcheckd_shm *shm)
+{
+    __atomic_store_n(&shm->generation, shm->generation + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+/**
+ * Finish to write the state file
+ * @param shm the mapped state file
+ */
+static inline void
+ifcheckd_shm_write_end(struct ifcheckd_shm *shm)
+{
+    __atomic_store_n(&shm->generation, shm->generation + 1, __ATOMIC_RELEASE);
+}
+
+/**
+ * Check whether the writer of a snapshot is running
+ * @param copy the snapshot
+ * @return if the writer is running, 1. otherwise 0.
+ */
+static inline int
+ifcheckd_shm_writer_alive(const struct ifcheckd_shm *copy)
+{
+    if (copy->pid <= 0) {
+        return 0;
+    }
+    return kill((pid_t) copy->pid, 0) == 0 || errno == EPERM;
+}
+
+/**
+ * Copy a consistent snapshot of the state file
+ * @param shm the mapped state file
+ * @param copy the snapshot
+ * @return if a consistent snapshot of a known layout is copied and its
+ * writer is running, 1. otherwise 0.
+ */
+static inline int
+ifcheckd_shm_read(const struct ifcheckd_shm *shm,
+        struct ifcheckd_shm *copy)
+{
+    uint32_t before, after;
+    int i;
+
+    for (i = 0; i < IFCHECKD_SHM_READ_RETRIES; i++) {
+        before = __atomic_load_n(&shm->generation, __ATOMIC_ACQUIRE);
+        if (before & 1) {
+            continue;
+        }
+        memcpy(copy, shm, sizeof(*copy));
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        after = __atomic_load_n(&shm->generation, __ATOMIC_RELAXED);
+        if (before == after) {
+            return copy->magic == IFCHECKD_SHM_MAGIC
+                    && copy->version == IFCHECKD_SHM_VERSION
+                    && copy->ring_count <= IFCHECKD_SHM_MAX_RINGS
+                    && ifcheckd_shm_writer_alive(copy);
+        }
+    }
+    return 0;
+}
+
+#endif /* IFCHECKD_SHM_H */
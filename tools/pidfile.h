@@ -0,0 +1,156 @@
+/*
+ * pidfile.h - pid file lock for the daemons running in the foreground
+ *
+ * Copyright (C) 2026 NIPPON TELEGRAPH AND TELEPHONE CORPORATION
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef PIDFILE_H
+#define PIDFILE_H
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <unistd.h>
+
+/* crm/crm.h and crm_internal.h are included before this file */
+
+/**
+ * a max buffer size of pid file
+ */
+#define LOCKSTRLEN  11
+
+/**
+ * this function is used when the program is executed as foreground
+ * (this is equal to the same name of function in utile.c)
+ */
+static inline int
+crm_pidfile_inuse(const char *filename, long mypid)
+{
+    long pid = 0;
+    struct stat sbuf;
+    char buf[LOCKSTRLEN + 1];
+    int rc = -ENOENT, fd = 0;
+
+    if ((fd = open(filename, O_RDONLY)) >= 0) {
+        if (fstat(fd, &sbuf) >= 0 && sbuf.st_size < LOCKSTRLEN) {
+            sleep(2);           /* if someone was about to create one,
+                                 * give'm a sec to do so
+                                 */
+        }
+        if (read(fd, buf, sizeof(buf)) > 0) {
+            if (sscanf(buf, "%lu", &pid) > 0) {
+                crm_trace("Got pid %lu from %s\n", pid, filename);
+                if (pid <= 1) {
+                    /* Invalid pid */
+                    rc = -ENOENT;
+                    unlink(filename);
+
+                } else if (mypid && pid == mypid) {
+                    /* In use by us */
+                    rc = pcmk_ok;
+
+                } else if (crm_pid_active(pid) == FALSE) {
+                    /* Contains a stale value */
+                    unlink(filename);
+                    rc = -ENOENT;
+
+                } else if (mypid && pid != mypid) {
+                    /* locked by existing process - give up */
+                    rc = -EEXIST;
+                }
+            }
+        }
+        close(fd);
+    }
+    return rc;
+}
+
+/**
+ * this function is used when the program is executed as foreground
+ * (this is equal to the same name of function in utile.c)
+ */
+static inline int
+crm_read_pidfile(const char *filename)
+{
+    int fd;
+    long pid = -1;
+    char buf[LOCKSTRLEN + 1];
+
+    if ((fd = open(filename, O_RDONLY)) < 0) {
+        goto bail;
+    }
+
+    if (read(fd, buf, sizeof(buf)) < 1) {
+        goto bail;
+    }
+
+    if (sscanf(buf, "%lu", &pid) > 0) {
+        if (pid <= 0) {
+            pid = -ESRCH;
+        }
+    }
+
+  bail:
+    if (fd >= 0) {
+        close(fd);
+    }
+    return pid;
+}
+
+/**
+ * this function is used the program is executed as foreground
+ * (this is equal to the same name of function in utile.c)
+ */
+static inline int
+crm_lock_pidfile(const char *filename)
+{
+    long mypid = 0;
+    int fd = 0, rc = 0;
+    char buf[LOCKSTRLEN + 1];
+
+    mypid = (unsigned long)getpid();
+
+    rc = crm_pidfile_inuse(filename, 0);
+    if (rc == -ENOENT) {
+        /* exists but the process is not active */
+
+    } else if (rc != pcmk_ok) {
+        /* locked by existing process - give up */
+        return rc;
+    }
+
+    if ((fd = open(filename, O_CREAT | O_WRONLY | O_EXCL, 0644)) < 0) {
+        /* Hmmh, why did we fail? Anyway, nothing we can do about it */
+        return -errno;
+    }
+
+    snprintf(buf, sizeof(buf), "%*lu\n", LOCKSTRLEN - 1, mypid);
+    rc = write(fd, buf, LOCKSTRLEN);
+    close(fd);
+
+    if (rc != LOCKSTRLEN) {
+        crm_perror(LOG_ERR, "Incomplete write to %s", filename);
+        return -errno;
+    }
+
+    return crm_pidfile_inuse(filename, mypid);
+}
+
+#endif /* PIDFILE_H */
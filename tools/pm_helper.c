@@ -0,0 +1,1702 @@
+/*
+ * pm_helper - Helper command for the pm_extras agents
+ *
+ * Copyright (C) 2026 NIPPON TELEGRAPH AND TELEPHONE CORPORATION
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <limits.h>
+#include <grp.h>
+#include <pwd.h>
+
+#include <corosync/cmap.h>
+#include <corosync/quorum.h>
+
+#include <crm/crm.h>
+#include <crm/stonith-ng.h>
+#include <crm/common/mainloop.h>
+#include <crm_internal.h>
+
+#include "ifcheckd_shm.h"
+#include "icmp_probe.h"
+#include "fencecheckd.h"
+#include "cmap_member.h"
+
+/**
+ * default system name
+ * (normally, execute file name)
+ */
+#define DEFAULT_SYS_NAME "pm_helper"
+
+/**
+ * exit code when the checked condition holds
+ * (quorate, etc)
+ */
+#define HELPER_RC_TRUE 0
+
+/**
+ * exit code when the checked condition does not hold
+ */
+#define HELPER_RC_FALSE 1
+
+/**
+ * exit code when the condition could not be decided
+ * (corosync is not reachable, etc)
+ */
+#define HELPER_RC_UNKNOWN 2
+
+/**
+ * exit code when the command cannot be executed
+ * (same as the shell)
+ */
+#define HELPER_RC_CANNOT_EXEC 126
+
+/**
+ * exit code when the command is not found
+ * (same as the shell)
+ */
+#define HELPER_RC_NOT_FOUND 127
+
+/**
+ * default PATH of the user for exec-as
+ */
+#define DEFAULT_USER_PATH "/usr/local/bin:/bin:/usr/bin"
+
+/**
+ * default upper bound of waiting(seconds)
+ */
+#define DEFAULT_TIMEOUT 10
+
+/**
+ * default time that the state has to stay unchanged(seconds)
+ */
+#define DEFAULT_SETTLE 2
+
+/**
+ * default number of echo replies that makes an address up
+ */
+#define DEFAULT_PROBE_COUNT 1
+
+/**
+ * default time without an echo reply that makes an address dead(seconds)
+ * (same as the default dead check of stonith-helper)
+ */
+#define DEFAULT_WINDOW 10
+
+/**
+ * the state of fencecheckd is fresh within this(milliseconds)
+ * (an address is alive if it replied within this, and the state is stale
+ * if fencecheckd did not probe for this)
+ */
+#define FENCE_VIEW_STALE_MSEC 3000
+
+/**
+ * max length of a reply line of fencecheckd
+ */
+#define FENCE_VIEW_LINE_LEN 512
+
+/**
+ * interval of echo requests to an address(milliseconds)
+ */
+#define PROBE_INTERVAL_MSEC 1000
+
+/**
+ * separator of the interface in a probed address
+ */
+#define PROBE_IF_SEPARATOR '%'
+
+/**
+ * separators of probed addresses in an argument
+ */
+#define PROBE_ADDR_SEPARATORS ", "
+
+/**
+ * size of the buffer to read /proc/<pid>/stat and cmdline
+ */
+#define PROC_READ_LEN 4096
+
+/**
+ * index of the start time in /proc/<pid>/stat
+ * (counted from the state field, which follows the command name)
+ */
+#define PROC_STAT_STARTTIME_INDEX 19
+
+/**
+ * interval of retries when corosync returns CS_ERR_TRY_AGAIN(microseconds)
+ */
+#define RETRY_INTERVAL_USEC 100000
+
+/**
+ * format to make the knet link key of a node in the stats map
+ * (corosync-3.x)
+ */
+#define KNET_NODE_SEARCH_FORMAT "stats.knet.node%u."
+
+/**
+ * format to get a link number and a last element from knet link key
+ */
+#define KNET_LINK_KEY_SCAN_FORMAT "stats.knet.node%*u.link%u.%s"
+
+/**
+ * short options
+ * ("+" stops the parsing at the command name)
+ */
+#define SHORT_OPTIONS "+?$Vt:s:c:w:"
+
+/**
+ * command table entry
+ */
+struct helper_command {
+    const char *name; /**< command name */
+    int min_args; /**< minimum number of command arguments */
+    int (*run)(int argc, char **argv); /**< command function */
+};
+
+/**
+ * probed address
+ */
+struct probe_target {
+    char *name; /**< address without the interface */
+    char *ifname; /**< interface to send from, or NULL */
+    struct sockaddr_storage addr; /**< resolved address */
+    socklen_t addrlen; /**< length of addr */
+    gboolean raw; /**< TRUE if fd is a raw socket, FALSE if a ping socket */
+    int fd; /**< ICMP socket */
+    mainloop_io_t *source; /**< socket fd source */
+    uint16_t seq; /**< sequence number of the last echo request */
+    guint received; /**< the number of echo replies */
+    gboolean failed; /**< TRUE if the address cannot be probed */
+};
+
+/**
+ * mainloop
+ */
+static GMainLoop *mainloop = NULL;
+
+/**
+ * result of the running command
+ */
+static int helper_result = HELPER_RC_UNKNOWN;
+
+/**
+ * upper bound of waiting(seconds)
+ */
+static guint opt_timeout = DEFAULT_TIMEOUT;
+
+/**
+ * settle time(seconds)
+ */
+static guint opt_settle = DEFAULT_SETTLE;
+
+/**
+ * the number of echo replies that makes an address up
+ */
+static guint opt_count = DEFAULT_PROBE_COUNT;
+
+/**
+ * time without an echo reply that makes an address dead(seconds)
+ */
+static guint opt_window = DEFAULT_WINDOW;
+
+/**
+ * the deadline of the command(monotonic time, microseconds)
+ */
+static gint64 helper_deadline;
+
+/**
+ * quorum watch state
+ */
+static struct {
+    quorum_handle_t handle; /**< quorum handler */
+    mainloop_io_t *source; /**< quorum fd source */
+    gboolean known; /**< TRUE after the first notification */
+    uint32_t quorate; /**< the last notified quorum state */
+    guint settle_id; /**< settle timer id */
+} q_watch;
+
+/**
+ * standby wait state
+ */
+static struct {
+    const char *host; /**< the fencing target */
+    gboolean has_nodeid; /**< TRUE if the target is in the nodelist */
+    uint32_t nodeid; /**< the nodeid of the target */
+    cmap_handle_t handle; /**< cmap handler */
+    mainloop_io_t *source; /**< cmap fd source */
+    cmap_track_handle_t track[CMAP_MEMBER_KEY_VERSIONS]; /**< member key track handlers */
+    stonith_t *st; /**< stonith API connection */
+} s_watch;
+
+/**
+ * probe state
+ */
+static struct {
+    struct probe_target *targets; /**< probed addresses */
+    int ntargets; /**< the number of probed addresses */
+    uint16_t ident; /**< identifier of echo requests */
+} p_probe;
+
+/**
+ * options index
+ */
+static struct crm_option long_options[] = {
+        {"help", 0, 0, '?', "\tThis text"},
+        {"version", 0, 0, '$', "\tVersion information"},
+        {"verbose", 0, 0, 'V', "\tIncrease debug output"},
+        {"timeout", 1, 0, 't', "\tUpper bound of waiting in seconds"},
+        {"settle", 1, 0, 's', "\tSeconds the state has to stay unchanged"},
+        {"count", 1, 0, 'c', "\tEcho replies that make an address up (probe)"},
+        {"window", 1, 0, 'w', "\tSeconds without a reply that make an address dead (fence-view)"},
+        {"-spacer-", 0, 0, '-', "\nCommands:"},
+        {"-spacer-", 0, 0, '-', " quorum-wait\t\tWait until the quorum state settles."
+                "\n\t\t\tExit 0 if quorate, 1 if not, 2 if unknown"},
+        {"-spacer-", 0, 0, '-', " member-online <host>\tCheck whether the host is in the corosync membership."
+                "\n\t\t\tExit 0 if online, 1 if not, 2 if unknown"},
+        {"-spacer-", 0, 0, '-', " link-down <host>\tCheck whether every corosync link to the host is down."
+                "\n\t\t\tExit 0 if all down, 1 if a link is up, 2 if unknown"},
+        {"-spacer-", 0, 0, '-', " exec-as <user> [NAME=VALUE ...] <command> [args]"
+                "\n\t\t\tExecute the command as the user without a login shell."
+                "\n\t\t\tExit with the exit code of the command"},
+        {"-spacer-", 0, 0, '-', " standby-wait <host>\tWait until the host rejoins or is fenced."
+                "\n\t\t\tExit 0 if decided, 1 if timed out, 2 if it cannot be watched"},
+        {"-spacer-", 0, 0, '-', " probe <address[%interface]>[,...] ..."
+                "\n\t\t\tSend ICMP echo requests to all the addresses at once."
+                "\n\t\t\tExit 0 if an address is up, 1 if none, 2 on error"},
+        {"-spacer-", 0, 0, '-', " ring-state [ring]\tPrint the ring state exported by ifcheckd."
+                "\n\t\t\tExit 0 if all rings are UP, 1 if not, 2 if unknown"},
+        {"-spacer-", 0, 0, '-', " pid-find <path>\tPrint the PID and the start time of the oldest process"
+                "\n\t\t\twhose command is the path."
+                "\n\t\t\tExit 0 if found, 1 if not, 2 on error"},
+        {"-spacer-", 0, 0, '-', " fence-view <host> [address[%interface]][,...] ..."
+                "\n\t\t\tPrint the verdicts of dead_check, quorum and member"
+                "\n\t\t\tfrom the state kept by fencecheckd."
+                "\n\t\t\tExit 0 if the state is got, 2 if not"},
+        {NULL, 0, 0, 0}
+};
+
+/**
+ * Stop the mainloop with a result
+ * @param result the exit code of the command
+ */
+static void
+_helper_finish(int result)
+{
+    helper_result = result;
+    if (mainloop != NULL && g_main_loop_is_running(mainloop)) {
+        g_main_loop_quit(mainloop);
+    }
+}
+
+/**
+ * Timeout function for the upper bound of waiting
+ * @param verdict the function which decides the result at the deadline
+ * @return always FALSE
+ */
+static gboolean
+_helper_deadline(gpointer verdict)
+{
+    int (*decide)(void) = verdict;
+
+    crm_debug("Reached the upper bound of waiting [%u(s)]", opt_timeout);
+    _helper_finish(decide());
+    return FALSE;
+}
+
+/**
+ * Run the mainloop until the command is decided or timed out
+ * @param verdict the function which decides the result at the deadline
+ * @return the exit code of the command
+ */
+static int
+_helper_run_mainloop(int (*verdict)(void))
+{
+    guint deadline_id;
+
+    deadline_id = g_timeout_add(opt_timeout * 1000, _helper_deadline, verdict);
+    g_main_loop_run(mainloop);
+    g_source_remove(deadline_id);
+    return helper_result;
+}
+
+/**
+ * Decide whether a corosync call should be retried
+ * @param rc the result of the corosync call
+ * @return if it is CS_ERR_TRY_AGAIN before the deadline, TRUE. otherwise FALSE.
+ */
+static gboolean
+_helper_retry(cs_error_t rc)
+{
+    if (rc != CS_ERR_TRY_AGAIN || g_get_monotonic_time() >= helper_deadline) {
+        return FALSE;
+    }
+    usleep(RETRY_INTERVAL_USEC);
+    return TRUE;
+}
+
+/**
+ * Connect to cmap until the deadline
+ * @param handle cmap handler
+ * @return if cmap can be connected, TRUE. otherwise FALSE.
+ */
+static gboolean
+_cmap_connect(cmap_handle_t *handle)
+{
+    cs_error_t rc;
+
+    while ((rc = cmap_initialize(handle)) != CS_OK && _helper_retry(rc)) {
+        ;
+    }
+    if (rc != CS_OK) {
+        crm_err("Failed to initialize the cmap API. Error %d", rc);
+        return FALSE;
+    }
+    return TRUE;
+}
+
+/**
+ * Search the nodelist for a node by its name or ring0 address
+ * @param handle cmap handler
+ * @param host the node name (compared without case)
+ * @param nodeid the nodeid of the node
+ * @return if the node is found, TRUE. otherwise FALSE.
+ */
+static gboolean
+_cmap_find_nodeid(cmap_handle_t handle,
+        const char *host,
+        uint32_t *nodeid)
+{
+    cs_error_t rc;
+
+    rc = cmap_member_find_nodeid(handle, host, nodeid, _helper_retry);
+    if (rc == CS_OK) {
+        crm_debug("%s is found in the nodelist [nodeid=%u]", host, *nodeid);
+        return TRUE;
+    }
+    if (rc != CS_ERR_NOT_EXIST) {
+        crm_debug("Failed to search the nodelist. Error %d", rc);
+    }
+    return FALSE;
+}
+
+/**
+ * Get the membership of a node
+ * @param handle cmap handler
+ * @param nodeid the nodeid of the node
+ * @return joined is HELPER_RC_TRUE, left or never joined is HELPER_RC_FALSE,
+ * otherwise HELPER_RC_UNKNOWN
+ */
+static int
+_cmap_member_status(cmap_handle_t handle,
+        uint32_t nodeid)
+{
+    enum cmap_member_state state;
+    cs_error_t rc;
+
+    rc = cmap_member_get_state(handle, nodeid, _helper_retry, &state);
+    if (rc != CS_OK) {
+        crm_debug("Failed to get the membership of nodeid %u. Error %d", nodeid, rc);
+        return HELPER_RC_UNKNOWN;
+    }
+    crm_debug("nodeid %u is %s", nodeid,
+            state == CMAP_MEMBER_JOINED ? "joined" : "not joined");
+    return state == CMAP_MEMBER_JOINED ? HELPER_RC_TRUE : HELPER_RC_FALSE;
+}
+
+/**
+ * Decide the quorum state at the deadline
+ * @return quorate is HELPER_RC_TRUE, not quorate is HELPER_RC_FALSE,
+ * no notification is HELPER_RC_UNKNOWN
+ */
+static int
+_quorum_verdict(void)
+{
+    if (q_watch.known == FALSE) {
+        return HELPER_RC_UNKNOWN;
+    }
+    return q_watch.quorate ? HELPER_RC_TRUE : HELPER_RC_FALSE;
+}
+
+/**
+ * Timeout function for the settle time
+ * @return always FALSE
+ */
+static gboolean
+_quorum_settled(gpointer data)
+{
+    q_watch.settle_id = 0;
+    crm_debug("Quorum state settled [quorate=%u]", q_watch.quorate);
+    _helper_finish(_quorum_verdict());
+    return FALSE;
+}
+
+/**
+ * quorum notification function
+ * @see in detail about arguments, see corosync quorum API
+ */
+static void
+_cs_quorum_notify(quorum_handle_t handle,
+        uint32_t quorate,
+        uint64_t ring_seq,
+        uint32_t view_list_entries,
+        uint32_t *view_list)
+{
+    crm_debug("Quorum notification [quorate=%u, ring_seq=%llu, members=%u]",
+            quorate, (unsigned long long)ring_seq, view_list_entries);
+
+    if (q_watch.known && q_watch.quorate == quorate) {
+        return;
+    }
+    q_watch.known = TRUE;
+    q_watch.quorate = quorate;
+
+    /* restart the settle time whenever the state changes */
+    if (q_watch.settle_id != 0) {
+        g_source_remove(q_watch.settle_id);
+    }
+    q_watch.settle_id = g_timeout_add(opt_settle * 1000, _quorum_settled, NULL);
+}
+
+/**
+ * quorum dispatch function
+ * @param user_data the gpointer of user data
+ * @return CS_OK is 0, otherwise, -1
+ */
+static int
+_cs_quorum_dispatch(gpointer user_data)
+{
+    cs_error_t rc = quorum_dispatch(q_watch.handle, CS_DISPATCH_ALL);
+    if (rc != CS_OK) {
+        crm_debug("Failed to dispatch quorum: Error %d", rc);
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * quorum destroy function
+ * @param user_data the gpointer of user data
+ */
+static void
+_cs_quorum_destroy(gpointer user_data)
+{
+    crm_debug("quorum connection is destroyed");
+    q_watch.source = NULL;
+    _helper_finish(HELPER_RC_UNKNOWN);
+}
+
+/**
+ * "quorum-wait" command.
+ * Subscribe to quorum notifications and return as soon as the quorum
+ * state stayed unchanged for the settle time.
+ * @return quorate is HELPER_RC_TRUE, not quorate is HELPER_RC_FALSE,
+ * otherwise HELPER_RC_UNKNOWN
+ */
+static int
+_cmd_quorum_wait(int argc, char **argv)
+{
+    cs_error_t rc;
+    uint32_t quorum_type = 0;
+    int quorum_fd = 0;
+    int result = HELPER_RC_UNKNOWN;
+
+    static quorum_callbacks_t quorum_callbacks = {
+            .quorum_notify_fn = _cs_quorum_notify,
+    };
+    static struct mainloop_fd_callbacks quorum_fd_callbacks = {
+            .dispatch = _cs_quorum_dispatch,
+            .destroy = _cs_quorum_destroy,
+    };
+
+    rc = quorum_initialize(&q_watch.handle, &quorum_callbacks, &quorum_type);
+    if (rc != CS_OK) {
+        crm_err("Failed to initialize the quorum API. Error %d", rc);
+        return HELPER_RC_UNKNOWN;
+    }
+
+    if (quorum_type != 1) {
+        crm_err("Corosync quorum is not configured");
+        goto bail;
+    }
+
+    rc = quorum_fd_get(q_watch.handle, &quorum_fd);
+    if (rc != CS_OK) {
+        crm_err("Failed to get quorum fd. Error %d", rc);
+        goto bail;
+    }
+
+    q_watch.source = mainloop_add_fd("corosync-quorum",
+            G_PRIORITY_DEFAULT,
+            quorum_fd,
+            &q_watch.handle,
+            &quorum_fd_callbacks);
+    if (q_watch.source == NULL) {
+        crm_err("Failed to add quorum fd to mainloop");
+        goto bail;
+    }
+
+    rc = quorum_trackstart(q_watch.handle, CS_TRACK_CURRENT | CS_TRACK_CHANGES);
+    if (rc != CS_OK) {
+        crm_err("Failed to track quorum. Error %d", rc);
+        goto bail2;
+    }
+
+    result = _helper_run_mainloop(_quorum_verdict);
+    crm_info("Quorum check finished [result=%d]", result);
+
+    (void) quorum_trackstop(q_watch.handle);
+
+    bail2:
+    if (q_watch.source != NULL) {
+        mainloop_del_fd(q_watch.source);
+    }
+
+    bail:
+    (void) quorum_finalize(q_watch.handle);
+    return result;
+}
+
+/**
+ * "member-online" command.
+ * Look up the node in the nodelist and its status in the corosync
+ * membership.
+ * @return online is HELPER_RC_TRUE, not online is HELPER_RC_FALSE,
+ * otherwise HELPER_RC_UNKNOWN
+ */
+static int
+_cmd_member_online(int argc, char **argv)
+{
+    cmap_handle_t handle;
+    uint32_t nodeid;
+    int result = HELPER_RC_UNKNOWN;
+
+    if (_cmap_connect(&handle) == FALSE) {
+        return HELPER_RC_UNKNOWN;
+    }
+
+    if (_cmap_find_nodeid(handle, argv[0], &nodeid) == FALSE) {
+        crm_info("%s is not found in the nodelist", argv[0]);
+        goto out_free;
+    }
+
+    result = _cmap_member_status(handle, nodeid);
+    crm_info("Membership check of %s finished [nodeid=%u, result=%d]",
+            argv[0], nodeid, result);
+
+    out_free:
+        (void) cmap_finalize(handle);
+        return result;
+}
+
+/**
+ * Get the knet link state of a node from the stats map
+ * @param nodeid the nodeid of the node
+ * @return all links are down is HELPER_RC_TRUE, a link is up is
+ * HELPER_RC_FALSE, no link state is HELPER_RC_UNKNOWN
+ */
+static int
+_cmap_knet_link_down(uint32_t nodeid)
+{
+#if HAVE_CMAP_STATS
+    cmap_handle_t handle;
+    cs_error_t rc;
+    cmap_iter_handle_t iter_handle;
+    char key_name[CMAP_KEYNAME_MAXLEN + 1];
+    char prefix[CMAP_KEYNAME_MAXLEN + 1];
+    char tmp_key[CMAP_KEYNAME_MAXLEN + 1];
+    size_t value_len;
+    cmap_value_types_t type;
+    unsigned int link_no;
+    uint8_t connected;
+    int links = 0;
+    int result = HELPER_RC_UNKNOWN;
+
+    while ((rc = cmap_initialize_map(&handle, CMAP_MAP_STATS)) != CS_OK
+            && _helper_retry(rc)) {
+        ;
+    }
+    if (rc != CS_OK) {
+        crm_debug("Failed to initialize the cmap stats map. Error %d", rc);
+        return HELPER_RC_UNKNOWN;
+    }
+
+    snprintf(prefix, sizeof(prefix), KNET_NODE_SEARCH_FORMAT, nodeid);
+    if (cmap_iter_init(handle, prefix, &iter_handle) != CS_OK) {
+        goto out_free;
+    }
+    while (cmap_iter_next(handle, iter_handle, key_name, &value_len, &type) == CS_OK) {
+        if (sscanf(key_name, KNET_LINK_KEY_SCAN_FORMAT, &link_no, tmp_key) != 2
+                || strcmp(tmp_key, "connected") != 0) {
+            continue;
+        }
+        if (cmap_get_uint8(handle, key_name, &connected) != CS_OK) {
+            continue;
+        }
+        crm_debug("%s=%u", key_name, connected);
+        links++;
+        if (connected) {
+            result = HELPER_RC_FALSE;
+            break;
+        }
+    }
+    (void) cmap_iter_finalize(handle, iter_handle);
+
+    if (result == HELPER_RC_UNKNOWN && links > 0) {
+        result = HELPER_RC_TRUE;
+    }
+
+    out_free:
+        (void) cmap_finalize(handle);
+        return result;
+#else
+    return HELPER_RC_UNKNOWN;
+#endif
+}
+
+/**
+ * "link-down" command.
+ * Check the knet link state toward the node (corosync-3.x). Without
+ * the link state, a node out of the totem membership is regarded as
+ * unreachable on every ring.
+ * @return all links are down is HELPER_RC_TRUE, a link is up is
+ * HELPER_RC_FALSE, otherwise HELPER_RC_UNKNOWN
+ */
+static int
+_cmd_link_down(int argc, char **argv)
+{
+    cmap_handle_t handle;
+    uint32_t nodeid;
+    int result = HELPER_RC_UNKNOWN;
+
+    if (_cmap_connect(&handle) == FALSE) {
+        return HELPER_RC_UNKNOWN;
+    }
+
+    if (_cmap_find_nodeid(handle, argv[0], &nodeid) == FALSE) {
+        crm_info("%s is not found in the nodelist", argv[0]);
+        goto out_free;
+    }
+
+    result = _cmap_knet_link_down(nodeid);
+    if (result == HELPER_RC_UNKNOWN) {
+        switch (_cmap_member_status(handle, nodeid)) {
+        case HELPER_RC_TRUE:
+            result = HELPER_RC_FALSE;
+            break;
+        case HELPER_RC_FALSE:
+            result = HELPER_RC_TRUE;
+            break;
+        default:
+            break;
+        }
+    }
+    crm_info("Link check of %s finished [nodeid=%u, result=%d]",
+            argv[0], nodeid, result);
+
+    out_free:
+        (void) cmap_finalize(handle);
+        return result;
+}
+
+/**
+ * Decide the standby wait at the deadline
+ * @return always HELPER_RC_FALSE
+ */
+static int
+_standby_verdict(void)
+{
+    return HELPER_RC_FALSE;
+}
+
+/**
+ * cmap member key trace function
+ * @see in detail about arguments, see corosync cmap API
+ */
+static void
+_cs_cmap_member_key_changed(cmap_handle_t cmap_handle_c,
+        cmap_track_handle_t cmap_track_handle,
+        int32_t event,
+        const char *key_name,
+        struct cmap_notify_value new_value,
+        struct cmap_notify_value old_value,
+        void *user_data)
+{
+    const char *prefix = user_data;
+    char tmp_key[CMAP_KEYNAME_MAXLEN + 1];
+
+    snprintf(tmp_key, sizeof(tmp_key), CMAP_MEMBER_STATUS_FORMAT, prefix, s_watch.nodeid);
+    if (strcmp(key_name, tmp_key) != 0) {
+        return;
+    }
+    if (new_value.type != CMAP_VALUETYPE_STRING
+            || new_value.len < strlen(CMAP_MEMBER_STATUS_JOINED)
+            || strncmp(new_value.data, CMAP_MEMBER_STATUS_JOINED,
+                    strlen(CMAP_MEMBER_STATUS_JOINED)) != 0) {
+        crm_debug("%s is changed but not joined", tmp_key);
+        return;
+    }
+    crm_info("%s rejoined the membership. Stop standby wait.", s_watch.host);
+    _helper_finish(HELPER_RC_TRUE);
+}
+
+/**
+ * cmap dispatch function for standby wait
+ * @param user_data the gpointer of user data
+ * @return CS_OK is 0, otherwise, -1
+ */
+static int
+_cs_standby_cmap_dispatch(gpointer user_data)
+{
+    cs_error_t rc = cmap_dispatch(s_watch.handle, CS_DISPATCH_ALL);
+    if (rc != CS_OK) {
+        crm_debug("Failed to dispatch cmap: Error %d", rc);
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * cmap destroy function for standby wait.
+ * The wait continues until the deadline.
+ * @param user_data the gpointer of user data
+ */
+static void
+_cs_standby_cmap_destroy(gpointer user_data)
+{
+    s_watch.source = NULL;
+    if (g_main_loop_is_running(mainloop)) {
+        crm_notice("cmap connection is destroyed. Wait without membership events.");
+    }
+}
+
+/**
+ * Start to watch the membership of the target
+ * @return if the membership can be watched, TRUE. otherwise FALSE.
+ */
+static gboolean
+_standby_watch_member(void)
+{
+    static const char *prefixes[CMAP_MEMBER_KEY_VERSIONS] = {
+            CMAP_MEMBER_KEY_V3, CMAP_MEMBER_KEY_V2
+    };
+    static struct mainloop_fd_callbacks cmap_fd_callbacks = {
+            .dispatch = _cs_standby_cmap_dispatch,
+            .destroy = _cs_standby_cmap_destroy,
+    };
+    cs_error_t rc;
+    int cmap_fd = 0;
+    int i;
+
+    if (_cmap_connect(&s_watch.handle) == FALSE) {
+        return FALSE;
+    }
+
+    s_watch.has_nodeid = _cmap_find_nodeid(s_watch.handle, s_watch.host, &s_watch.nodeid);
+    if (s_watch.has_nodeid == FALSE) {
+        crm_info("%s is not found in the nodelist", s_watch.host);
+        goto bail;
+    }
+
+    rc = cmap_fd_get(s_watch.handle, &cmap_fd);
+    if (rc != CS_OK) {
+        crm_debug("Failed to get cmap fd. Error %d", rc);
+        goto bail;
+    }
+
+    for (i = 0; i < CMAP_MEMBER_KEY_VERSIONS; i++) {
+        rc = cmap_track_add(s_watch.handle,
+                prefixes[i],
+                CMAP_TRACK_ADD | CMAP_TRACK_MODIFY | CMAP_TRACK_PREFIX,
+                _cs_cmap_member_key_changed,
+                (void *) prefixes[i],
+                &s_watch.track[i]);
+        if (rc != CS_OK) {
+            crm_debug("Failed to track the member key. Error %d", rc);
+            goto bail;
+        }
+    }
+
+    s_watch.source = mainloop_add_fd("corosync-cmap",
+            G_PRIORITY_DEFAULT,
+            cmap_fd,
+            &s_watch.handle,
+            &cmap_fd_callbacks);
+    if (s_watch.source == NULL) {
+        crm_debug("Failed to add cmap fd to mainloop");
+        goto bail;
+    }
+    return TRUE;
+
+    bail:
+    (void) cmap_finalize(s_watch.handle);
+    s_watch.handle = 0;
+    return FALSE;
+}
+
+/**
+ * stonith fence notification function
+ * @param st stonith API connection
+ * @param e the fence event
+ */
+static void
+_st_fence_notify(stonith_t *st,
+        stonith_event_t *e)
+{
+    if (e->target == NULL || g_ascii_strcasecmp(e->target, s_watch.host) != 0) {
+        return;
+    }
+    crm_debug("Fence event of %s [operation=%s, result=%d, executioner=%s]",
+            e->target, e->operation, e->result, e->executioner);
+    if (e->result != pcmk_ok) {
+        return;
+    }
+    crm_info("%s was fenced by %s. Stop standby wait.", e->target, e->executioner);
+    _helper_finish(HELPER_RC_TRUE);
+}
+
+/**
+ * Start to watch the fencing events of the target
+ * @return if the fencing events can be watched, TRUE. otherwise FALSE.
+ */
+static gboolean
+_standby_watch_fencing(void)
+{
+    int rc;
+
+    s_watch.st = stonith_api_new();
+    if (s_watch.st == NULL) {
+        return FALSE;
+    }
+
+    /* the connection is dispatched by the mainloop without fd */
+    rc = s_watch.st->cmds->connect(s_watch.st, crm_system_name, NULL);
+    if (rc != pcmk_ok) {
+        crm_debug("Failed to connect to stonithd: %s (%d)", pcmk_strerror(rc), rc);
+        goto bail;
+    }
+
+    rc = s_watch.st->cmds->register_notification(s_watch.st,
+            T_STONITH_NOTIFY_FENCE, _st_fence_notify);
+    if (rc != pcmk_ok) {
+        crm_debug("Failed to register the fence notification: %s (%d)",
+                pcmk_strerror(rc), rc);
+        (void) s_watch.st->cmds->disconnect(s_watch.st);
+        goto bail;
+    }
+    return TRUE;
+
+    bail:
+    stonith_api_delete(s_watch.st);
+    s_watch.st = NULL;
+    return FALSE;
+}
+
+/**
+ * "standby-wait" command.
+ * Wait until the target rejoins the membership or is fenced.
+ * @return decided is HELPER_RC_TRUE, timed out is HELPER_RC_FALSE,
+ * otherwise HELPER_RC_UNKNOWN
+ */
+static int
+_cmd_standby_wait(int argc, char **argv)
+{
+    gboolean watch_member;
+    gboolean watch_fencing;
+    int result;
+    int i;
+
+    s_watch.host = argv[0];
+    watch_member = _standby_watch_member();
+    watch_fencing = _standby_watch_fencing();
+
+    if (watch_member == FALSE && watch_fencing == FALSE) {
+        crm_err("Cannot watch either membership or fencing of %s", s_watch.host);
+        return HELPER_RC_UNKNOWN;
+    }
+    crm_debug("Start standby wait [host=%s, membership=%d, fencing=%d]",
+            s_watch.host, watch_member, watch_fencing);
+
+    result = _helper_run_mainloop(_standby_verdict);
+    crm_info("Standby wait of %s finished [result=%d]", s_watch.host, result);
+
+    if (watch_fencing) {
+        (void) s_watch.st->cmds->remove_notification(s_watch.st, T_STONITH_NOTIFY_FENCE);
+        (void) s_watch.st->cmds->disconnect(s_watch.st);
+        stonith_api_delete(s_watch.st);
+    }
+    if (watch_member) {
+        for (i = 0; i < CMAP_MEMBER_KEY_VERSIONS; i++) {
+            (void) cmap_track_delete(s_watch.handle, s_watch.track[i]);
+        }
+        if (s_watch.source != NULL) {
+            mainloop_del_fd(s_watch.source);
+        }
+        (void) cmap_finalize(s_watch.handle);
+    }
+    return result;
+}
+
+/**
+ * "exec-as" command.
+ * Set the groups, gid and uid of the user and the environment, then
+ * execute the command. The environment consists of HOME, SHELL, USER,
+ * LOGNAME, PATH and the NAME=VALUE arguments.
+ * @return if the command cannot be executed, HELPER_RC_CANNOT_EXEC or
+ * HELPER_RC_NOT_FOUND. otherwise, this does not return.
+ */
+static int
+_cmd_exec_as(int argc, char **argv)
+{
+    struct passwd *pw;
+    int i;
+
+    pw = getpwnam(argv[0]);
+    if (pw == NULL) {
+        crm_err("There is no user : %s", argv[0]);
+        return HELPER_RC_CANNOT_EXEC;
+    }
+
+    if (clearenv() != 0
+            || setenv("HOME", pw->pw_dir, 1) != 0
+            || setenv("SHELL", pw->pw_shell, 1) != 0
+            || setenv("USER", pw->pw_name, 1) != 0
+            || setenv("LOGNAME", pw->pw_name, 1) != 0
+            || setenv("PATH", DEFAULT_USER_PATH, 1) != 0) {
+        crm_perror(LOG_ERR, "Could not set the environment of %s", pw->pw_name);
+        return HELPER_RC_CANNOT_EXEC;
+    }
+    for (i = 1; i < argc && strchr(argv[i], '=') != NULL; i++) {
+        if (putenv(argv[i]) != 0) {
+            crm_perror(LOG_ERR, "Could not set %s", argv[i]);
+            return HELPER_RC_CANNOT_EXEC;
+        }
+    }
+    if (i >= argc) {
+        crm_err("No command to execute as %s", pw->pw_name);
+        return HELPER_RC_CANNOT_EXEC;
+    }
+
+    if (initgroups(pw->pw_name, pw->pw_gid) != 0
+            || setgid(pw->pw_gid) != 0
+            || setuid(pw->pw_uid) != 0) {
+        crm_perror(LOG_ERR, "Could not change the user to %s", pw->pw_name);
+        return HELPER_RC_CANNOT_EXEC;
+    }
+    if (chdir(pw->pw_dir) != 0 && chdir("/") != 0) {
+        crm_perror(LOG_ERR, "Could not change the directory");
+        return HELPER_RC_CANNOT_EXEC;
+    }
+
+    crm_debug("Execute %s as %s", argv[i], pw->pw_name);
+    execvp(argv[i], argv + i);
+
+    crm_perror(LOG_ERR, "Could not execute %s", argv[i]);
+    return errno == ENOENT ? HELPER_RC_NOT_FOUND : HELPER_RC_CANNOT_EXEC;
+}
+
+/**
+ * Parse a probed address and resolve it
+ * @param t the probed address
+ * @param spec the address in "address[%interface]" form
+ * @return if the address can be resolved, TRUE. otherwise FALSE.
+ */
+static gboolean
+_probe_parse(struct probe_target *t,
+        const char *spec)
+{
+    char *sep;
+    int rc;
+
+    t->fd = -1;
+    t->name = strdup(spec);
+    sep = strchr(t->name, PROBE_IF_SEPARATOR);
+    if (sep != NULL) {
+        *sep = '\0';
+        if (sep[1] != '\0') {
+            t->ifname = strdup(sep + 1);
+        }
+    }
+    if (t->name[0] == '\0') {
+        crm_err("Address is empty : %s", spec);
+        return FALSE;
+    }
+
+    rc = icmp_probe_resolve(t->name, t->ifname, &t->addr, &t->addrlen);
+    if (rc != 0) {
+        crm_err("Cannot resolve %s : %s", t->name, gai_strerror(rc));
+        return FALSE;
+    }
+    return TRUE;
+}
+
+/**
+ * Open the ICMP socket of a probed address.
+ * A raw socket is used if it is permitted, otherwise a ping socket.
+ * @param t the probed address
+ * @return if the socket can be opened, TRUE. otherwise FALSE.
+ */
+static gboolean
+_probe_open(struct probe_target *t)
+{
+    int raw;
+
+    t->fd = icmp_probe_open(&t->addr, t->addrlen, t->ifname, &raw);
+    if (t->fd < 0) {
+        crm_perror(LOG_ERR, "Could not open an ICMP socket for %s", t->name);
+        return FALSE;
+    }
+    t->raw = raw ? TRUE : FALSE;
+    return TRUE;
+}
+
+/**
+ * Send an echo request to a probed address.
+ * An unreachable address is not an error, it is just not up.
+ * @param t the probed address
+ */
+static void
+_probe_send(struct probe_target *t)
+{
+    t->seq++;
+    if (icmp_probe_send(t->fd, t->addr.ss_family, p_probe.ident, t->seq) < 0) {
+        switch (errno) {
+        case ENETUNREACH:
+        case EHOSTUNREACH:
+        case EHOSTDOWN:
+        case EAGAIN:
+            crm_debug("Could not send an echo request to %s: %s",
+                    t->name, strerror(errno));
+            break;
+        default:
+            crm_perror(LOG_ERR, "Could not send an echo request to %s", t->name);
+            t->failed = TRUE;
+            break;
+        }
+    }
+}
+
+/**
+ * Decide the probe result
+ * @return an address is up is HELPER_RC_TRUE, an address cannot be probed
+ * is HELPER_RC_UNKNOWN, otherwise HELPER_RC_FALSE
+ */
+static int
+_probe_verdict(void)
+{
+    int result = HELPER_RC_FALSE;
+    int i;
+
+    for (i = 0; i < p_probe.ntargets; i++) {
+        if (p_probe.targets[i].received >= opt_count) {
+            return HELPER_RC_TRUE;
+        }
+        if (p_probe.targets[i].failed) {
+            result = HELPER_RC_UNKNOWN;
+        }
+    }
+    return result;
+}
+
+/**
+ * Timeout function to send the next echo requests
+ * @return always TRUE
+ */
+static gboolean
+_probe_tick(gpointer data)
+{
+    int i;
+
+    for (i = 0; i < p_probe.ntargets; i++) {
+        if (p_probe.targets[i].failed == FALSE) {
+            _probe_send(&p_probe.targets[i]);
+        }
+    }
+    return TRUE;
+}
+
+/**
+ * ICMP socket dispatch function
+ * @param user_data the probed address
+ * @return always 0
+ */
+static int
+_probe_dispatch(gpointer user_data)
+{
+    struct probe_target *t = user_data;
+    uint16_t id, seq;
+    int rc;
+
+    while ((rc = icmp_probe_recv(t->fd, t->addr.ss_family, t->raw, &id, &seq)) >= 0) {
+        /* a ping socket rewrites the identifier by itself */
+        if (rc == 0 || (t->raw && id != p_probe.ident) || seq == 0 || seq > t->seq) {
+            continue;
+        }
+        t->received++;
+        crm_debug("%s replied [seq=%u, received=%u]", t->name, seq, t->received);
+        if (t->received >= opt_count) {
+            crm_info("%s responded.", t->name);
+            _helper_finish(HELPER_RC_TRUE);
+        }
+    }
+    return 0;
+}
+
+/**
+ * ICMP socket destroy function
+ * @param user_data the probed address
+ */
+static void
+_probe_destroy(gpointer user_data)
+{
+    struct probe_target *t = user_data;
+
+    t->source = NULL;
+}
+
+/**
+ * "probe" command.
+ * Send ICMP echo requests every second to all the addresses at once,
+ * like running ping for each of them in parallel. An address is up
+ * when it replied -c times until -t seconds.
+ * @return an address is up is HELPER_RC_TRUE, no address is up is
+ * HELPER_RC_FALSE, otherwise HELPER_RC_UNKNOWN
+ */
+static int
+_cmd_probe(int argc, char **argv)
+{
+    struct probe_target *t;
+    char *list, *spec, *saveptr;
+    guint tick_id;
+    int result = HELPER_RC_UNKNOWN;
+    int i;
+
+    static struct mainloop_fd_callbacks probe_fd_callbacks = {
+            .dispatch = _probe_dispatch,
+            .destroy = _probe_destroy,
+    };
+
+    p_probe.ident = (uint16_t) getpid();
+    for (i = 0; i < argc; i++) {
+        list = strdup(argv[i]);
+        for (spec = strtok_r(list, PROBE_ADDR_SEPARATORS, &saveptr); spec != NULL;
+                spec = strtok_r(NULL, PROBE_ADDR_SEPARATORS, &saveptr)) {
+            p_probe.targets = realloc(p_probe.targets,
+                    sizeof(struct probe_target) * (p_probe.ntargets + 1));
+            t = &p_probe.targets[p_probe.ntargets++];
+            memset(t, 0, sizeof(*t));
+            if (_probe_parse(t, spec) == FALSE) {
+                free(list);
+                goto out_free;
+            }
+        }
+        free(list);
+    }
+    if (p_probe.ntargets == 0) {
+        crm_err("No address to probe");
+        goto out_free;
+    }
+
+    for (i = 0; i < p_probe.ntargets; i++) {
+        t = &p_probe.targets[i];
+        if (_probe_open(t) == FALSE) {
+            goto out_free;
+        }
+        t->source = mainloop_add_fd("probe", G_PRIORITY_DEFAULT, t->fd, t,
+                &probe_fd_callbacks);
+        if (t->source == NULL) {
+            crm_err("Failed to add the ICMP socket of %s to mainloop", t->name);
+            goto out_free;
+        }
+    }
+
+    _probe_tick(NULL);
+    tick_id = g_timeout_add(PROBE_INTERVAL_MSEC, _probe_tick, NULL);
+    result = _helper_run_mainloop(_probe_verdict);
+    g_source_remove(tick_id);
+    crm_debug("Probe finished [result=%d]", result);
+
+    out_free:
+    for (i = 0; i < p_probe.ntargets; i++) {
+        t = &p_probe.targets[i];
+        if (t->source != NULL) {
+            mainloop_del_fd(t->source);
+        } else if (t->fd >= 0) {
+            close(t->fd);
+        }
+        free(t->name);
+        free(t->ifname);
+    }
+    free(p_probe.targets);
+    return result;
+}
+
+/**
+ * Read the state and the start time of a process
+ * @param pid the process id
+ * @param starttime the start time in clock ticks after boot
+ * @return if the process exists and is not a zombie, TRUE. otherwise FALSE.
+ */
+static gboolean
+_proc_starttime(const char *pid,
+        unsigned long long *starttime)
+{
+    char path[PATH_MAX];
+    char buf[PROC_READ_LEN];
+    char *p, *saveptr;
+    FILE *fp;
+    int i;
+
+    snprintf(path, sizeof(path), "/proc/%s/stat", pid);
+    fp = fopen(path, "r");
+    if (fp == NULL) {
+        return FALSE;
+    }
+    p = fgets(buf, sizeof(buf), fp);
+    fclose(fp);
+    if (p == NULL || (p = strrchr(buf, ')')) == NULL) {
+        return FALSE;
+    }
+
+    p = strtok_r(p + 1, " ", &saveptr);
+    if (p == NULL || strcmp(p, "Z") == 0) {
+        return FALSE;
+    }
+    for (i = 0; i < PROC_STAT_STARTTIME_INDEX && p != NULL; i++) {
+        p = strtok_r(NULL, " ", &saveptr);
+    }
+    if (p == NULL) {
+        return FALSE;
+    }
+    *starttime = strtoull(p, NULL, 10);
+    return TRUE;
+}
+
+/**
+ * Check whether the command of a process is the path
+ * @param pid the process id
+ * @param cmd the path of the command
+ * @return if the first argument of the process is the path, TRUE.
+ * otherwise FALSE.
+ */
+static gboolean
+_proc_command_is(const char *pid,
+        const char *cmd)
+{
+    char path[PATH_MAX];
+    char buf[PROC_READ_LEN];
+    size_t len;
+    FILE *fp;
+
+    snprintf(path, sizeof(path), "/proc/%s/cmdline", pid);
+    fp = fopen(path, "r");
+    if (fp == NULL) {
+        return FALSE;
+    }
+    len = fread(buf, 1, sizeof(buf) - 1, fp);
+    fclose(fp);
+    buf[len] = '\0';
+
+    /* the arguments may be rewritten into one, separated by spaces */
+    len = strlen(cmd);
+    return strncmp(buf, cmd, len) == 0 && (buf[len] == '\0' || buf[len] == ' ');
+}
+
+/**
+ * "pid-find" command.
+ * Scan /proc for the oldest process whose command is the path, and print
+ * "<pid> <start time>". The start time tells a reused PID from the process.
+ * @return found is HELPER_RC_TRUE, not found is HELPER_RC_FALSE,
+ * otherwise HELPER_RC_UNKNOWN
+ */
+static int
+_cmd_pid_find(int argc, char **argv)
+{
+    DIR *dir;
+    struct dirent *entry;
+    unsigned long long starttime, found_starttime = 0;
+    long found_pid = 0;
+    long self = (long) getpid();
+
+    dir = opendir("/proc");
+    if (dir == NULL) {
+        crm_perror(LOG_ERR, "Could not open /proc");
+        return HELPER_RC_UNKNOWN;
+    }
+    while ((entry = readdir(dir)) != NULL) {
+        if (entry->d_name[0] < '1' || entry->d_name[0] > '9'
+                || atol(entry->d_name) == self) {
+            continue;
+        }
+        if (_proc_command_is(entry->d_name, argv[0]) == FALSE
+                || _proc_starttime(entry->d_name, &starttime) == FALSE) {
+            continue;
+        }
+        if (found_pid == 0 || starttime < found_starttime) {
+            found_pid = atol(entry->d_name);
+            found_starttime = starttime;
+        }
+    }
+    closedir(dir);
+
+    if (found_pid == 0) {
+        return HELPER_RC_FALSE;
+    }
+    printf("%ld %llu\n", found_pid, found_starttime);
+    return HELPER_RC_TRUE;
+}
+
+/**
+ * Name of a ring state in the state file
+ * @param state enum ifcheckd_shm_state
+ * @return the name
+ */
+static const char *
+_shm_state_name(uint32_t state)
+{
+    switch (state) {
+    case IFCHECKD_SHM_STATE_UP:
+        return "UP";
+    case IFCHECKD_SHM_STATE_FAULTY:
+        return "FAULTY";
+    default:
+        return "UNKNOWN";
+    }
+}
+
+/**
+ * Name of a carrier state in the state file
+ * @param carrier enum ifcheckd_shm_carrier
+ * @return the name
+ */
+static const char *
+_shm_carrier_name(uint32_t carrier)
+{
+    switch (carrier) {
+    case IFCHECKD_SHM_CARRIER_UP:
+        return "UP";
+    case IFCHECKD_SHM_CARRIER_LOST:
+        return "LOST";
+    default:
+        return "UNKNOWN";
+    }
+}
+
+/**
+ * "ring-state" command.
+ * Read the state file of ifcheckd without IPC, and print
+ * "<ring> <address> <state> <carrier> <last change(epoch seconds)>" per ring.
+ * @return all the rings are UP is HELPER_RC_TRUE, a ring is not UP is
+ * HELPER_RC_FALSE, otherwise HELPER_RC_UNKNOWN
+ */
+static int
+_cmd_ring_state(int argc, char **argv)
+{
+    struct ifcheckd_shm *shm;
+    struct ifcheckd_shm copy;
+    struct ifcheckd_shm_ring *ring;
+    struct stat st;
+    uint32_t first = 0;
+    uint32_t last;
+    uint32_t i;
+    int result = HELPER_RC_TRUE;
+    int fd;
+
+    fd = open(IFCHECKD_SHM_FILE, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        crm_perror(LOG_INFO, "Could not open %s", IFCHECKD_SHM_FILE);
+        return HELPER_RC_UNKNOWN;
+    }
+    if (fstat(fd, &st) != 0 || st.st_size < sizeof(struct ifcheckd_shm)) {
+        crm_info("%s is not a state file of this version", IFCHECKD_SHM_FILE);
+        close(fd);
+        return HELPER_RC_UNKNOWN;
+    }
+    shm = mmap(NULL, sizeof(struct ifcheckd_shm), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (shm == MAP_FAILED) {
+        crm_perror(LOG_ERR, "Could not map %s", IFCHECKD_SHM_FILE);
+        return HELPER_RC_UNKNOWN;
+    }
+    if (ifcheckd_shm_read(shm, &copy) == 0) {
+        crm_info("Could not read %s, or ifcheckd is not running", IFCHECKD_SHM_FILE);
+        munmap(shm, sizeof(struct ifcheckd_shm));
+        return HELPER_RC_UNKNOWN;
+    }
+    munmap(shm, sizeof(struct ifcheckd_shm));
+
+    last = copy.ring_count;
+    if (argc > 0) {
+        first = (uint32_t) strtoul(argv[0], NULL, 10);
+        last = first + 1;
+    }
+    if (last > copy.ring_count || first >= last) {
+        crm_info("ifcheckd does not monitor the ring [rings=%u]", copy.ring_count);
+        return HELPER_RC_UNKNOWN;
+    }
+
+    for (i = first; i < last; i++) {
+        ring = &copy.rings[i];
+        printf("%u %s %s %s %lld\n", i, ring->addr,
+                _shm_state_name(ring->state),
+                _shm_carrier_name(ring->carrier),
+                (long long) (ring->last_change / G_USEC_PER_SEC));
+        if (ring->state != IFCHECKD_SHM_STATE_UP) {
+            result = HELPER_RC_FALSE;
+        }
+    }
+    return result;
+}
+
+/**
+ * Send a view request to fencecheckd
+ * @param argc the number of command arguments
+ * @param argv the host and the addresses
+ * @return the connected socket, or -1
+ */
+static int
+_fence_view_request(int argc,
+        char **argv)
+{
+    struct sockaddr_un addr;
+    struct timeval tv;
+    GString *request;
+    char *list, *spec, *saveptr;
+    ssize_t len;
+    int fd;
+    int i;
+
+    fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        crm_perror(LOG_ERR, "Could not open a socket");
+        return -1;
+    }
+    tv.tv_sec = opt_timeout;
+    tv.tv_usec = 0;
+    (void) setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    (void) setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    snprintf(addr.sun_path, sizeof(addr.sun_path), "%s", FENCECHECKD_SOCKET);
+    if (connect(fd, (struct sockaddr *) &addr, sizeof(addr)) != 0) {
+        crm_perror(LOG_INFO, "Could not connect to %s", FENCECHECKD_SOCKET);
+        close(fd);
+        return -1;
+    }
+
+    request = g_string_new(FENCECHECKD_CMD_VIEW);
+    g_string_append_printf(request, " %s", argv[0]);
+    for (i = 1; i < argc; i++) {
+        list = strdup(argv[i]);
+        for (spec = strtok_r(list, PROBE_ADDR_SEPARATORS, &saveptr); spec != NULL;
+                spec = strtok_r(NULL, PROBE_ADDR_SEPARATORS, &saveptr)) {
+            g_string_append_printf(request, " %s", spec);
+        }
+        free(list);
+    }
+    g_string_append(request, "\n");
+    len = send(fd, request->str, request->len, MSG_NOSIGNAL);
+    if (len < 0 || len != request->len) {
+        crm_perror(LOG_ERR, "Could not send a request to fencecheckd");
+        close(fd);
+        fd = -1;
+    }
+    g_string_free(request, TRUE);
+    return fd;
+}
+
+/**
+ * "fence-view" command.
+ * Get the state kept by fencecheckd, and print the verdicts
+ * "dead_check dead|alive|unknown", "quorum quorate|no-quorum|unknown" and
+ * "member online|offline|unknown". An address is alive if it replied just
+ * now, and dead if fencecheckd has probed it for -w seconds without a
+ * reply. The quorum state is decided if it stayed unchanged for -s seconds.
+ * The verdict is unknown if the state is not enough or stale.
+ * @return the state is got is HELPER_RC_TRUE, otherwise HELPER_RC_UNKNOWN
+ */
+static int
+_cmd_fence_view(int argc, char **argv)
+{
+    char line[FENCE_VIEW_LINE_LEN];
+    char name[FENCE_VIEW_LINE_LEN];
+    char state[FENCE_VIEW_LINE_LEN];
+    long long window = (long long) opt_window * 1000;
+    long long probing, reply_age, tick_age, changed;
+    const char *dead_check = "unknown";
+    const char *quorum = "unknown";
+    const char *member = "unknown";
+    unsigned int version = 0;
+    int connected, quorate;
+    int targets = 0, alive = 0, down = 0;
+    gboolean ended = FALSE;
+    FILE *fp;
+    int fd;
+
+    fd = _fence_view_request(argc, argv);
+    if (fd < 0) {
+        return HELPER_RC_UNKNOWN;
+    }
+    fp = fdopen(fd, "r");
+    if (fp == NULL) {
+        close(fd);
+        return HELPER_RC_UNKNOWN;
+    }
+
+    while (ended == FALSE && fgets(line, sizeof(line), fp) != NULL) {
+        if (sscanf(line, FENCECHECKD_REPLY_VERSION_FORMAT, &version) == 1) {
+            continue;
+        }
+        if (sscanf(line, FENCECHECKD_REPLY_QUORUM_FORMAT,
+                        &connected, &quorate, &changed) == 3) {
+            if (connected && changed >= (long long) opt_settle * 1000) {
+                quorum = quorate ? "quorate" : "no-quorum";
+            }
+        } else if (sscanf(line, FENCECHECKD_REPLY_MEMBER_FORMAT, name, state) == 2) {
+            if (strcmp(state, FENCECHECKD_MEMBER_JOINED) == 0) {
+                member = "online";
+            } else if (strcmp(state, FENCECHECKD_MEMBER_LEFT) == 0) {
+                member = "offline";
+            }
+        } else if (sscanf(line, FENCECHECKD_REPLY_TARGET_FORMAT,
+                        name, &probing, &reply_age, &tick_age) == 4) {
+            crm_debug("%s [probing=%lld, reply=%lld, tick=%lld]",
+                    name, probing, reply_age, tick_age);
+            targets++;
+            if (tick_age < 0 || tick_age > FENCE_VIEW_STALE_MSEC) {
+                continue;
+            }
+            if (reply_age >= 0 && reply_age <= FENCE_VIEW_STALE_MSEC) {
+                alive++;
+            } else if (probing >= window && (reply_age < 0 || reply_age >= window)) {
+                down++;
+            }
+        } else if (strcmp(line, FENCECHECKD_REPLY_END) == 0) {
+            ended = TRUE;
+        }
+    }
+    fclose(fp);
+
+    if (ended == FALSE || version != FENCECHECKD_VERSION) {
+        crm_info("Could not get the state from fencecheckd [version=%u]", version);
+        return HELPER_RC_UNKNOWN;
+    }
+    if (alive > 0) {
+        dead_check = "alive";
+    } else if (targets > 0 && down == targets) {
+        dead_check = "dead";
+    }
+    crm_info("Fence view of %s [dead_check=%s, quorum=%s, member=%s]",
+            argv[0], dead_check, quorum, member);
+    printf("dead_check %s\nquorum %s\nmember %s\n", dead_check, quorum, member);
+    return HELPER_RC_TRUE;
+}
+
+/**
+ * command table
+ */
+static struct helper_command commands[] = {
+        {"quorum-wait", 0, _cmd_quorum_wait},
+        {"member-online", 1, _cmd_member_online},
+        {"link-down", 1, _cmd_link_down},
+        {"exec-as", 2, _cmd_exec_as},
+        {"standby-wait", 1, _cmd_standby_wait},
+        {"probe", 1, _cmd_probe},
+        {"pid-find", 1, _cmd_pid_find},
+        {"ring-state", 0, _cmd_ring_state},
+        {"fence-view", 1, _cmd_fence_view},
+        {NULL, 0, NULL}
+};
+
+/**
+ * Main function
+ * @return the exit code of the command
+ */
+int
+main(int argc, char **argv)
+{
+    const char *crm_system_name = DEFAULT_SYS_NAME;
+    struct helper_command *cmd;
+    int option_index = 0;
+    int flag;
+
+    crm_log_init(crm_system_name,
+            LOG_INFO,
+            FALSE,
+            FALSE,
+            argc,
+            argv,
+            TRUE);
+    crm_set_options(SHORT_OPTIONS,
+            "[options] command [arguments]",
+            long_options,
+            "Helper command for the pm_extras agents");
+
+    while (1) {
+        flag = crm_get_option(argc, argv, &option_index);
+        if (flag == -1)
+            break;
+
+        switch (flag) {
+        case 'V':
+            crm_bump_log_level(argc, argv);
+            break;
+        case 't':
+            opt_timeout = (guint) strtoul(optarg, NULL, 10);
+            break;
+        case 's':
+            opt_settle = (guint) strtoul(optarg, NULL, 10);
+            break;
+        case 'c':
+            opt_count = (guint) strtoul(optarg, NULL, 10);
+            break;
+        case 'w':
+            opt_window = (guint) strtoul(optarg, NULL, 10);
+            break;
+        case '?':
+        case '$':
+            crm_help(flag, EX_OK);
+            break;
+        default:
+            crm_help(flag, EX_USAGE);
+            break;
+        }
+    }
+
+    if (optind >= argc) {
+        crm_help('?', EX_USAGE);
+    }
+
+    for (cmd = commands; cmd->name != NULL; cmd++) {
+        if (strcmp(cmd->name, argv[optind]) == 0) {
+            break;
+        }
+    }
+    if (cmd->name == NULL || argc - optind - 1 < cmd->min_args) {
+        crm_help('?', EX_USAGE);
+    }
+
+    helper_deadline = g_get_monotonic_time() + (gint64) opt_timeout * G_USEC_PER_SEC;
+    mainloop = g_main_loop_new(NULL, FALSE);
+    return crm_exit(cmd->run(argc - optind - 1, argv + optind + 1));
+}